@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <limits>
 
 #include "include/allocator.h"
 #include "include/basic_block.h"
@@ -9,15 +10,23 @@ namespace compiler {
 
 BasicBlock::BasicBlock(Graph *graph) {
     graph_ = graph;
-    id_ = graph_->GetBlocksNum();
-    graph_->IncreaseBlocksNum();
+    id_ = graph_->GenBlockId(this);
 }
 
 BasicBlock::BasicBlock(InstructionBase *first_instr, InstructionBase *last_instr, Graph *graph) : first_instr_(first_instr),
                                                                                                   last_instr_(last_instr) {
+    SetGraph(graph);
+    id_ = graph_->GenBlockId(this);
+}
+
+void BasicBlock::SetGraph(Graph *graph) {
     graph_ = graph;
-    id_ = graph_->GetBlocksNum();
-    graph_->IncreaseBlocksNum();
+    if (graph_ == nullptr) {
+        return;
+    }
+    for (auto *instr: GetInstrs()) {
+        graph_->AddInstr(instr);
+    }
 }
 
 std::set<size_t> BasicBlock::CollectIds(const BlocksVector &bbs) {
@@ -32,9 +41,7 @@ size_t BasicBlock::GetId() {
     if (id_.has_value()) {
         return id_.value();
     }
-    id_ = graph_->GetBlocksNum();
-    graph_->IncreaseBlocksNum();
-    return id_.value();
+    return graph_->GenBlockId(this);
 }
 
 BasicBlock BasicBlock::MakeBasicBlock(const std::vector<InstructionBase *> &instrs) {
@@ -67,6 +74,22 @@ void BasicBlock::RemoveFromSuccs(size_t id) {
     auto it = std::find_if(succs_.begin(), succs_.end(),
                            [id](BasicBlock *bb) { return bb->GetId() == id; });
     succs_.erase(it);
+    InvalidateCfgOrder();
+}
+
+void BasicBlock::ReplaceSucc(BasicBlock *old_succ, BasicBlock *new_succ) {
+    auto it = std::find(succs_.begin(), succs_.end(), old_succ);
+    assert(it != succs_.end());
+    *it = new_succ;
+    old_succ->RemoveFromPreds(GetId());
+    new_succ->AddToPreds({this});
+    InvalidateCfgOrder();
+}
+
+void BasicBlock::InvalidateCfgOrder() {
+    if (graph_ != nullptr) {
+        graph_->InvalidateRpo();
+    }
 }
 
 void BasicBlock::RemoveFromPreds(size_t id) {
@@ -75,9 +98,22 @@ void BasicBlock::RemoveFromPreds(size_t id) {
     preds_.erase(it);
 }
 
-bool BasicBlock::IsDominatedBy(BasicBlock *dom) {
-    return (std::find_if(dom_blocks_.begin(), dom_blocks_.end(),
-                         [dom](BasicBlock *bb) { return dom->GetId() == bb->GetId(); }) != dom_blocks_.end());
+BlocksVector BasicBlock::GetDomBlocks() const {
+    BlocksVector doms;
+    if (imm_dom_ == nullptr) {
+        return doms;
+    }
+    if (imm_dom_ == this) {
+        doms.push_back(imm_dom_);  // root
+        return doms;
+    }
+    for (auto *dom = imm_dom_;; dom = dom->imm_dom_) {
+        doms.push_back(dom);
+        if (dom->imm_dom_ == dom) {
+            break;
+        }
+    }
+    return doms;
 }
 
 bool BasicBlock::IsLoopHeader() const {
@@ -85,6 +121,11 @@ bool BasicBlock::IsLoopHeader() const {
     return loop_->GetHeader()->GetId() == id_;
 }
 
+uint32_t BasicBlock::GetLoopDepth() const {
+    assert(loop_ != nullptr);
+    return loop_->GetDepth();
+}
+
 InsnsVec BasicBlock::GetAllInstrs() {
     InsnsVec instrs;
     InstructionBase *it_instr = first_instr_;
@@ -109,14 +150,60 @@ BasicBlock *BasicBlock::SplitOn(InstructionBase *insn) {
     }
     insn->SetNext(nullptr);
     SetLastInstr(insn);
-    BasicBlock *second_bb = graph_->GetAllocator()->New(MakeBasicBlock(second_bb_instrs));
+    BasicBlock *second_bb = graph_->GetAllocator()->New<BasicBlock>(MakeBasicBlock(second_bb_instrs));
     second_bb->SetGraph(graph_);
     MoveSuccs(second_bb);
+    if (loop_ != nullptr && graph_->IsLoopAnalysisValid()) {
+        loop_->AddSplitBlock(this, second_bb);
+    }
     return second_bb;
 }
 
+void BasicBlock::EraseInstr(InstructionBase *instr) {
+    assert(graph_ != nullptr && "Graph is needed to get the allocator");
+    auto *next = instr->GetNext();
+    RemoveInstr(instr);
+    if (instr == first_phi_) {
+        first_phi_ = next != nullptr && next->GetOpcode() == Opcode::PHI ? static_cast<DynamicInputInstr *>(next)
+                                                                         : nullptr;
+    }
+    instr->SetPrev(nullptr);
+    instr->SetNext(nullptr);
+    instr->SetBasicBlock(nullptr);
+    graph_->RemoveInstr(instr);
+    InstructionBase::Delete(graph_->GetAllocator(), instr);
+}
+
+void BasicBlock::RenumberInstrs() {
+    uint64_t order = 0;
+    for (auto *instr: GetInstrs()) {
+        order += INSTR_ORDER_STEP;
+        assert(order <= std::numeric_limits<uint32_t>::max() && "Too many instructions in the block");
+        instr->SetOrder(static_cast<uint32_t>(order));
+    }
+    instrs_order_valid_ = true;
+}
+
+void BasicBlock::AssignOrder(InstructionBase *instr) {
+    if (!instrs_order_valid_) {
+        return;
+    }
+    auto *prev = instr->GetPrev();
+    auto *next = instr->GetNext();
+    uint64_t low = prev != nullptr ? prev->GetOrder() : 0;
+    uint64_t high = next != nullptr ? next->GetOrder() : low + 2 * INSTR_ORDER_STEP;
+    if (high - low < 2 || high > std::numeric_limits<uint32_t>::max()) {
+        instrs_order_valid_ = false;
+        return;
+    }
+    instr->SetOrder(static_cast<uint32_t>(low + (high - low) / 2));
+}
+
 void BasicBlock::InsertInstrBefore(InstructionBase *bb_instr, InstructionBase *instr) {
     instr->SetBasicBlock(this);
+    if (graph_ != nullptr) {
+        graph_->AddInstr(instr);
+    }
     if (bb_instr->GetPrev() != nullptr) {
         bb_instr->GetPrev()->SetNext(instr);
         instr->SetPrev(bb_instr->GetPrev());
@@ -126,10 +213,14 @@ void BasicBlock::InsertInstrBefore(InstructionBase *bb_instr, InstructionBase *i
     if (bb_instr == first_instr_) {
         first_instr_ = instr;
     }
+    AssignOrder(instr);
 }
 
 void BasicBlock::InsertInstrAfter(InstructionBase *bb_instr, InstructionBase *instr) {
     instr->SetBasicBlock(this);
+    if (graph_ != nullptr) {
+        graph_->AddInstr(instr);
+    }
     if (bb_instr->GetNext() != nullptr) {
         bb_instr->GetNext()->SetPrev(instr);
     }
@@ -139,6 +230,7 @@ void BasicBlock::InsertInstrAfter(InstructionBase *bb_instr, InstructionBase *in
     if (bb_instr == last_instr_) {
         last_instr_ = instr;
     }
+    AssignOrder(instr);
 }
 
 }  // namespace compiler
\ No newline at end of file
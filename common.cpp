@@ -3,7 +3,7 @@
 
 namespace compiler {
 
-InstrArg::InstrArg(Type type, vreg_t num, InstructionBase *ref) : type_(type), num_(num), ref_(ref) {
+InstrArg::InstrArg(Type type, vreg_t num, InstructionBase *ref) : ref_(ref), num_(num), type_(type) {
     if (type == Type::id) {
         ref_->SetIsTarget(true);
     }
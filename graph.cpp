@@ -1,17 +1,156 @@
 #include "include/graph.h"
 #include "include/basic_block.h"
 #include "passes/include/pass.h"
+#include "passes/include/analysis_manager.h"
+#include "passes/include/loop.h"
 #include <algorithm>
 
 namespace compiler {
 
-size_t Graph::instrs_count_ = 0;
+std::atomic<size_t> Graph::detached_instrs_count_{0};
+std::atomic<uint32_t> Graph::markers_epoch_{1};
+
+AnalysisManagerHolder::AnalysisManagerHolder() = default;
+
+AnalysisManagerHolder::AnalysisManagerHolder(const AnalysisManagerHolder &) {}
+
+AnalysisManagerHolder &AnalysisManagerHolder::operator=(const AnalysisManagerHolder &) {
+    manager_.reset();
+    return *this;
+}
+
+AnalysisManagerHolder::~AnalysisManagerHolder() = default;
+
+passes::AnalysisManager &AnalysisManagerHolder::Get(Graph *graph) {
+    if (manager_ == nullptr) {
+        manager_ = std::make_unique<passes::AnalysisManager>(graph);
+    }
+    return *manager_;
+}
+
+LoopsHolder::LoopsHolder() = default;
+
+LoopsHolder::LoopsHolder(const LoopsHolder &) {}
+
+LoopsHolder &LoopsHolder::operator=(const LoopsHolder &) {
+    Clear();
+    return *this;
+}
+
+LoopsHolder::~LoopsHolder() = default;
+
+Loop *LoopsHolder::New(BasicBlock *header) {
+    return loops_.Emplace(loops_num_++, header);
+}
+
+void LoopsHolder::Clear() {
+    loops_.Reset();
+    loops_num_ = 0;
+}
+
+void Graph::InvalidateAnalyses(const PreservedAnalyses &preserved) {
+    for (size_t i = 0; i < ANALYSES_NUM; ++i) {
+        if (!preserved.IsPreserved(static_cast<Analysis>(i))) {
+            valid_analyses_.reset(i);
+        }
+    }
+    if (!IsRpoValid()) {
+        InvalidateRpo();
+    }
+    if (!IsDomTreeValid()) {
+        InvalidateDomTree();
+    }
+}
 
 BasicBlock *Graph::FindBlock(size_t id) {
-    auto dfs_blocks = passes::Traversal{this}.getDFS(true);
-    auto it = std::find_if(dfs_blocks.begin(), dfs_blocks.end(),
-                        [id](BasicBlock *bb) { return bb->GetId() == id; });
-    return *it;
+    if (auto *bb = LookupBlock(id); bb != nullptr) {
+        return bb;
+    }
+    // ids are given lazily, the walk numbers all the reachable blocks
+    passes::Traversal tr{this};
+    tr.getDFS(true);
+    return LookupBlock(id);
+}
+
+BasicBlock *Graph::LookupBlock(size_t id) const {
+    if (id >= blocks_by_id_.size()) {
+        return nullptr;
+    }
+    BasicBlock *bb = blocks_by_id_[id];
+    // the block could be renumbered after it was put to the table, e.g. when it is moved to another graph
+    if (bb == nullptr || !bb->HasId() || bb->GetId() != id) {
+        return nullptr;
+    }
+    return bb;
+}
+
+size_t Graph::GenBlockId(BasicBlock *bb) {
+    size_t id = blocks_num_++;
+    SetBlockId(bb, id);
+    return id;
+}
+
+void Graph::SetBlockId(BasicBlock *bb, size_t id) {
+    bb->SetId(id);
+    if (id >= blocks_by_id_.size()) {
+        blocks_by_id_.resize(id + 1, nullptr);
+    }
+    blocks_by_id_[id] = bb;
+}
+
+void Graph::CompactBlockIds() {
+    passes::Traversal tr{this};
+    const BlocksVector &rpo = tr.getRPO();
+    blocks_by_id_.clear();
+    blocks_num_ = 0;
+    GenBlockId(root_);
+    if (end_ != nullptr && end_ != root_) {
+        GenBlockId(end_);
+    }
+    for (auto *bb: rpo) {
+        if (bb != root_ && bb != end_) {
+            GenBlockId(bb);
+        }
+    }
+}
+
+InstructionBase *Graph::FindInstr(size_t id) const {
+    if (id >= instrs_by_id_.size()) {
+        return nullptr;
+    }
+    InstructionBase *instr = instrs_by_id_[id];
+    // the instruction could be moved to another graph which has renumbered it
+    if (instr == nullptr || instr->GetId() != id || instr->GetBasicBlock()->GetGraph() != this) {
+        return nullptr;
+    }
+    return instr;
+}
+
+void Graph::AddInstr(InstructionBase *instr) {
+    assert(instr != nullptr);
+    if (IsInstrRegistered(instr)) {
+        return;
+    }
+    instr->SetId(GenInstrId());
+    instrs_by_id_.push_back(instr);
+}
+
+void Graph::RemoveInstr(InstructionBase *instr) {
+    if (IsInstrRegistered(instr)) {
+        instrs_by_id_[instr->GetId()] = nullptr;
+    }
+}
+
+void Graph::BuildHandles() {
+    block_handles_.Clear();
+    instr_handles_.Clear();
+    passes::Traversal tr{this};
+    for (auto *bb: tr.getRPO()) {
+        RegisterBlock(bb);
+        for (auto *instr: bb->GetInstrs()) {
+            RegisterInstr(instr);
+        }
+    }
 }
 
 void Graph::SetGraphForBasicBlocks(std::initializer_list<BasicBlock *> bbs) {
@@ -29,6 +168,7 @@ BasicBlock *Graph::RemoveBlock(size_t id) {
     for (auto *bb : rm_bb->GetPreds()) {
         bb->RemoveFromSuccs(rm_bb->GetId());
     }
+    InvalidateRpo();  // the preds might belong to a copy of this graph
     return rm_bb;
 }
 
@@ -36,6 +176,27 @@ void Graph::RestoreBlock(BasicBlock *rm_bb) {
     for (auto *bb : rm_bb->GetPreds()) {
         bb->AddToSuccs({rm_bb});
     }
+    InvalidateRpo();
+}
+
+Marker Graph::NewMarker() {
+    auto it = std::find(used_marker_slots_.begin(), used_marker_slots_.end(), false);
+    assert(it != used_marker_slots_.end() && "Too many markers are used at the same time");
+    *it = true;
+    uint32_t epoch = markers_epoch_.fetch_add(1, std::memory_order_relaxed);
+    assert(epoch < (1U << (32 - MARKER_SLOT_BITS)) && "Marker epochs are exhausted");
+    return Marker{epoch, static_cast<uint32_t>(it - used_marker_slots_.begin())};
+}
+
+void Graph::EraseMarker(Marker marker) {
+    assert(used_marker_slots_[marker.GetSlot()]);
+    used_marker_slots_[marker.GetSlot()] = false;
+}
+
+MarkerHolder::MarkerHolder(Graph *graph) : graph_(graph), marker_(graph->NewMarker()) {}
+
+MarkerHolder::~MarkerHolder() {
+    graph_->EraseMarker(marker_);
 }
 
 void Graph::AddLabel(const std::string &label) {
@@ -5,46 +5,328 @@
 #include <algorithm>
 #include <memory>
 #include <tuple>
+#include <array>
+#include <new>
+#include <mutex>
+#include <limits>
+#include <cstdint>
 #include <cassert>
 
 namespace compiler::storage {
 
+// Only const GetId() is taken into account: ids which are assigned lazily on the first call are not indexed
 template<class C>
 static constexpr bool HasGetIdMethod(...) { return false; }
 
 template<class C>
-static constexpr bool HasGetIdMethod(int, decltype((std::declval<C>().GetId(float()))) * = 0) { return true; }
+static constexpr bool HasGetIdMethod(int, decltype((std::declval<const C &>().GetId())) * = 0) { return true; }
 
-constexpr const size_t DEFAULT_RESERVED_SIZE = 1024;
+constexpr const size_t DEFAULT_SLAB_SIZE = 64 * 1024;  // in bytes
 
+/**
+ *  Memory accounting of one storage (or a sum of them). Fields are signed, so the difference of two
+ *  snapshots taken around a pass shows how much memory the pass has freed as well as allocated.
+ */
+struct AllocStats {
+    int64_t objects_num{0};  // live objects, recycled ones are not counted
+    int64_t bytes_reserved{0};  // requested from the system
+    int64_t bytes_used{0};  // occupied by live objects
+    int64_t peak_bytes_used{0};  // high-water mark of bytes_used, survives Reset
+
+    AllocStats &operator+=(const AllocStats &other) noexcept {
+        objects_num += other.objects_num;
+        bytes_reserved += other.bytes_reserved;
+        bytes_used += other.bytes_used;
+        peak_bytes_used += other.peak_bytes_used;
+        return *this;
+    }
+
+    AllocStats &operator-=(const AllocStats &other) noexcept {
+        objects_num -= other.objects_num;
+        bytes_reserved -= other.bytes_reserved;
+        bytes_used -= other.bytes_used;
+        peak_bytes_used -= other.peak_bytes_used;
+        return *this;
+    }
+
+    friend AllocStats operator+(AllocStats lhs, const AllocStats &rhs) noexcept {
+        return lhs += rhs;
+    }
+
+    friend AllocStats operator-(AllocStats lhs, const AllocStats &rhs) noexcept {
+        return lhs -= rhs;
+    }
+};
+
+/**
+ *  Chunked bump-pointer arena. Memory is requested from the system in fixed-size slabs which are never
+ *  relocated, so every pointer returned by the arena stays valid until the arena itself is destroyed.
+ */
 template<class C>
-class Storage final {
+class Arena final {
 public:
-    Storage() {
-        holder_.reserve(DEFAULT_RESERVED_SIZE);
+    Arena() = default;
+
+    explicit Arena(size_t slab_elems) : slab_elems_(slab_elems) {}
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    Arena(Arena &&other) noexcept : slab_elems_(other.slab_elems_), slabs_(std::move(other.slabs_)),
+                                    cur_slab_(other.cur_slab_), free_(std::move(other.free_)),
+                                    reserved_elems_(other.reserved_elems_), live_elems_(other.live_elems_),
+                                    peak_live_elems_(other.peak_live_elems_) {
+        other.slabs_.clear();
+        other.cur_slab_ = 0;
+        other.free_.clear();
+        other.reserved_elems_ = 0;
+        other.live_elems_ = 0;
+        other.peak_live_elems_ = 0;
+    }
+
+    Arena &operator=(Arena &&other) noexcept {
+        if (this != &other) {
+            Clear();
+            slab_elems_ = other.slab_elems_;
+            slabs_ = std::move(other.slabs_);
+            cur_slab_ = other.cur_slab_;
+            free_ = std::move(other.free_);
+            reserved_elems_ = other.reserved_elems_;
+            live_elems_ = other.live_elems_;
+            peak_live_elems_ = other.peak_live_elems_;
+            other.slabs_.clear();
+            other.cur_slab_ = 0;
+            other.free_.clear();
+            other.reserved_elems_ = 0;
+            other.live_elems_ = 0;
+            other.peak_live_elems_ = 0;
+        }
+        return *this;
+    }
+
+    ~Arena() {
+        Clear();
+    }
+
+    template<class... Args>
+    C *Emplace(Args &&... args) {
+        if (!free_.empty()) {
+            C *slot = free_.back();
+            free_.pop_back();
+            CountLive(1);
+            slot->~C();
+            return new(slot) C(std::forward<Args>(args)...);
+        }
+        return new(Reserve(1)) C(std::forward<Args>(args)...);
     }
 
-    explicit Storage(size_t reserved_size) {
-        holder_.reserve(reserved_size);
+    /**
+     *  Puts the object's slot to the free list, the next Emplace reuses it. The object is destroyed only
+     *  when its slot is reused (or the arena is reset), so every object is destroyed exactly once.
+     */
+    void Recycle(C *obj) {
+        assert(obj != nullptr);
+        assert(live_elems_ != 0);
+        free_.push_back(obj);
+        --live_elems_;
     }
 
-    void AddElem(C &&elem) {
-        holder_.push_back(std::forward<C>(elem));
+    [[nodiscard]] size_t GetFreeNum() const noexcept {
+        return free_.size();
+    }
+
+    // Constructs all the given objects in one contiguous run and returns pointer to the first one
+    template<class... Cls>
+    C *EmplaceRange(Cls &&... objs) {
+        if constexpr (sizeof...(Cls) == 0) {
+            return nullptr;
+        } else {
+            C *first = Reserve(sizeof...(Cls));
+            C *it = first;
+            ((new(it++) C(std::forward<Cls>(objs))), ...);
+            return first;
+        }
+    }
+
+    C *EmplaceRange(std::vector<C> &&objs) {
+        if (objs.empty()) {
+            return nullptr;
+        }
+        C *first = Reserve(objs.size());
+        C *it = first;
+        for (auto &obj: objs) {
+            new(it++) C(std::move(obj));
+        }
+        return first;
+    }
+
+    // Recycled objects are visited too
+    template<class Func>
+    void ForEach(Func &&func) const {
+        for (const auto &slab: slabs_) {
+            for (size_t i = 0; i < slab.used; ++i) {
+                func(slab.At(i));
+            }
+        }
+    }
+
+    [[nodiscard]] size_t GetSlabsNum() const noexcept {
+        return slabs_.size();
+    }
+
+    // O(1), the counters are maintained on every allocation
+    [[nodiscard]] AllocStats GetStats() const noexcept {
+        AllocStats stats;
+        stats.objects_num = static_cast<int64_t>(live_elems_);
+        stats.bytes_reserved = static_cast<int64_t>(reserved_elems_ * sizeof(C));
+        stats.bytes_used = static_cast<int64_t>(live_elems_ * sizeof(C));
+        stats.peak_bytes_used = static_cast<int64_t>(peak_live_elems_ * sizeof(C));
+        return stats;
+    }
+
+    /**
+     *  Drops all the objects but keeps the slabs for the next allocations. Destructors are run only for
+     *  non-trivially destructible objects, otherwise reset takes O(amount of slabs).
+     */
+    void Reset() noexcept {
+        for (auto &slab: slabs_) {
+            if constexpr (!std::is_trivially_destructible_v<C>) {
+                for (size_t i = 0; i < slab.used; ++i) {
+                    slab.At(i)->~C();
+                }
+            }
+            slab.used = 0;
+        }
+        cur_slab_ = 0;
+        free_.clear();
+        live_elems_ = 0;
+    }
+
+private:
+    struct Slab {
+        C *data{nullptr};  // raw memory, only first `used` cells are constructed
+        size_t capacity{0};
+        size_t used{0};
+
+        [[nodiscard]] C *At(size_t idx) const {
+            return std::launder(data + idx);
+        }
+    };
+
+    // Returns uninitialized memory for n contiguous objects, the next (kept after reset or new) slab is taken
+    // if the current one is full
+    C *Reserve(size_t n) {
+        assert(n != 0);
+        while (cur_slab_ < slabs_.size() && slabs_[cur_slab_].capacity - slabs_[cur_slab_].used < n) {
+            ++cur_slab_;
+        }
+        if (cur_slab_ == slabs_.size()) {
+            size_t slab_elems = slab_elems_ != 0 ? slab_elems_ : std::max<size_t>(DEFAULT_SLAB_SIZE / sizeof(C), 1);
+            size_t capacity = std::max(n, slab_elems);
+            auto *data = static_cast<C *>(::operator new(capacity * sizeof(C), std::align_val_t{alignof(C)}));
+            slabs_.push_back(Slab{data, capacity, 0});
+            reserved_elems_ += capacity;
+        }
+        Slab &slab = slabs_[cur_slab_];
+        C *mem = slab.data + slab.used;
+        slab.used += n;
+        CountLive(n);
+        return mem;
+    }
+
+    void CountLive(size_t n) noexcept {
+        live_elems_ += n;
+        peak_live_elems_ = std::max(peak_live_elems_, live_elems_);
+    }
+
+    void Clear() noexcept {
+        for (auto &slab: slabs_) {
+            for (size_t i = 0; i < slab.used; ++i) {
+                slab.At(i)->~C();
+            }
+            ::operator delete(slab.data, std::align_val_t{alignof(C)});
+        }
+        slabs_.clear();
+        cur_slab_ = 0;
+        free_.clear();
+        reserved_elems_ = 0;
+        live_elems_ = 0;
+    }
+
+    size_t slab_elems_{0};  // 0 means that slab size is calculated from DEFAULT_SLAB_SIZE
+    std::vector<Slab> slabs_;
+    size_t cur_slab_{0};  // slabs before it are full, slabs after it are empty
+    std::vector<C *> free_;  // recycled single slots
+
+    size_t reserved_elems_{0};  // total capacity of the slabs
+    size_t live_elems_{0};  // constructed and not recycled
+    size_t peak_live_elems_{0};
+};
+
+template<class C>
+class Storage final {
+public:
+    Storage() = default;
+
+    explicit Storage(size_t slab_elems) : holder_(slab_elems) {}
+
+    C *AddElem(C &&elem) {
+        return Emplace(std::forward<C>(elem));
+    }
+
+    template<class... Args>
+    C *Emplace(Args &&... args) {
+        back_ = holder_.Emplace(std::forward<Args>(args)...);
+        if (front_ == nullptr) {
+            front_ = back_;
+        }
+        if constexpr (HasGetIdMethod<C>(0)) {
+            IndexById(back_);
+        }
+        return back_;
     }
 
     [[nodiscard]] C *GetFrontPointer() const {
-        return &holder_.front();
+        return front_;
     }
 
     [[nodiscard]] C *GetBackPointer() {
-        return &holder_.back();
+        return back_;
     }
 
+    void Recycle(C *elem) {
+        if constexpr (HasGetIdMethod<C>(0)) {
+            size_t id = elem->GetId();
+            if (id >= id_base_ && id - id_base_ < id_table_.size() && id_table_[id - id_base_] == elem) {
+                id_table_[id - id_base_] = nullptr;
+            }
+        }
+        holder_.Recycle(elem);
+    }
+
+    [[nodiscard]] size_t GetFreeNum() const noexcept {
+        return holder_.GetFreeNum();
+    }
+
+    [[nodiscard]] AllocStats GetStats() const noexcept {
+        return holder_.GetStats();
+    }
+
+    void Reset() noexcept {
+        holder_.Reset();
+        front_ = nullptr;
+        back_ = nullptr;
+        id_table_.clear();
+        id_base_ = 0;
+    }
+
+    // Constant time lookup through the id table built on allocation
     [[nodiscard]] C *GetPointerById(size_t id) const {
         if constexpr (HasGetIdMethod<C>(0)) {
-            for (auto &elem: holder_) {
-                if (elem.GetId() == id) {
-                    return &elem;
+            if (id >= id_base_ && id - id_base_ < id_table_.size()) {
+                C *elem = id_table_[id - id_base_];
+                if (elem != nullptr && elem->GetId() == id) {  // id might be changed after allocation
+                    return elem;
                 }
             }
         }
@@ -52,84 +334,170 @@ public:
     }
 
 private:
-    std::vector<C> holder_;
+    void IndexById(C *elem) {
+        size_t id = elem->GetId();
+        if (id == static_cast<size_t>(-1)) {
+            return;  // id is not assigned yet
+        }
+        if (id_table_.empty()) {
+            id_base_ = id;
+        } else if (id < id_base_) {
+            id_table_.insert(id_table_.begin(), id_base_ - id, nullptr);
+            id_base_ = id;
+        }
+        if (id - id_base_ >= id_table_.size()) {
+            id_table_.resize(id - id_base_ + 1, nullptr);
+        }
+        id_table_[id - id_base_] = elem;
+    }
+
+    Arena<C> holder_;
+    C *front_{nullptr};
+    C *back_{nullptr};
+
+    // Dense table indexed by (id - id_base_), ids are generated sequentially so the table has few holes
+    std::vector<C *> id_table_;
+    size_t id_base_{0};
 };
 
+/**
+ *  Keeps pools of objects, every pool is a contiguous run inside the arena.
+ */
 template<class C>
 class PoolStorage final {
 public:
-    PoolStorage() {
-        holder_.reserve(DEFAULT_RESERVED_SIZE);
-    }
+    PoolStorage() = default;
 
-    explicit PoolStorage(size_t reserved_size) {
-        holder_.reserve(reserved_size);
-    }
+    explicit PoolStorage(size_t slab_elems) : holder_(slab_elems) {}
 
-    template<class... T, std::enable_if_t<(std::is_same_v<T, C> && ...), bool> = true>
+    template<class... T, std::enable_if_t<(std::is_constructible_v<C, T &&> && ...), bool> = true>
     void AddPool(T &&... classes) {
-        holder_.template emplace_back(std::vector<C>{std::forward<C>(classes)...});
-        std::vector<C *> pointers_pool;
-        std::transform(holder_.back().begin(), holder_.back().end(), std::back_inserter(pointers_pool),
-                       [](C &cls) { return &cls; });
-        pointers_holder_.template emplace_back(pointers_pool);
+        RegisterPool(holder_.EmplaceRange(std::forward<T>(classes)...), sizeof...(T));
     }
 
     void AddPool(std::vector<C> &&classes) {
-        holder_.template emplace_back(std::forward<std::vector<C>>(classes));
-        std::vector<C *> pointers_pool;
-        std::transform(holder_.back().begin(), holder_.back().end(), std::back_inserter(pointers_pool),
-                       [](C &cls) { return &cls; });
-        pointers_holder_.template emplace_back(pointers_pool);
+        size_t size = classes.size();
+        RegisterPool(holder_.EmplaceRange(std::forward<std::vector<C>>(classes)), size);
     }
 
     [[nodiscard]] std::vector<C *> GetFrontPointersPool() const {
-        return pointers_holder_.front();
+        return ToPointers(front_pool_);
     }
 
     [[nodiscard]] std::vector<C *> GetBackPointersPool() {
-        return pointers_holder_.back();
+        return ToPointers(back_pool_);
+    }
+
+    [[nodiscard]] AllocStats GetStats() const noexcept {
+        return holder_.GetStats();
+    }
+
+    void Reset() noexcept {
+        holder_.Reset();
+        front_pool_ = Pool{};
+        back_pool_ = Pool{};
+        has_pools_ = false;
     }
 
     template<size_t N>
     [[nodiscard]] auto GetFrontPointersPoolAsArray() {
-        const std::vector<C *> &vec = pointers_holder_.front();
-        assert(N == vec.size());
-        std::array<C *, N> arr;
-        std::copy_n(vec.begin(), N, arr.begin());
-        return arr;
+        return ToArray<N>(front_pool_);
     }
 
     template<size_t N>
     [[nodiscard]] auto GetBackPointersPoolAsArray() {
-        const std::vector<C *> &vec = pointers_holder_.back();
-        assert(N == vec.size());
+        return ToArray<N>(back_pool_);
+    }
+
+private:
+    struct Pool {
+        C *first{nullptr};
+        size_t size{0};
+    };
+
+    void RegisterPool(C *first, size_t size) {
+        back_pool_ = Pool{first, size};
+        if (!has_pools_) {
+            front_pool_ = back_pool_;
+            has_pools_ = true;
+        }
+    }
+
+    static std::vector<C *> ToPointers(const Pool &pool) {
+        std::vector<C *> pointers_pool(pool.size);
+        for (size_t i = 0; i < pool.size; ++i) {
+            pointers_pool[i] = pool.first + i;
+        }
+        return pointers_pool;
+    }
+
+    template<size_t N>
+    static std::array<C *, N> ToArray(const Pool &pool) {
+        assert(N == pool.size);
         std::array<C *, N> arr;
-        std::copy_n(vec.begin(), N, arr.begin());
+        for (size_t i = 0; i < N; ++i) {
+            arr[i] = pool.first + i;
+        }
         return arr;
     }
 
-private:
-    std::vector<std::vector<C>> holder_;
-    std::vector<std::vector<C *>> pointers_holder_;  // copy of holder_ but transformed to pointers
+    Arena<C> holder_;
+    Pool front_pool_;
+    Pool back_pool_;
+    bool has_pools_{false};
 };
 
 template<class... C>
 class Allocator final {
 public:
-    template<class Cls, std::enable_if_t<(std::is_same_v<Cls, C> || ...), bool> = true>
-    Cls *New(Cls &&cls) {
+    /**
+     *  Copy of the statistics of all the storages, per type in the order of the Allocator template
+     *  arguments. Snapshots are cheap, so they can be taken around every pass; subtract two of them to get
+     *  what happened in between.
+     */
+    struct Snapshot {
+        std::array<AllocStats, sizeof...(C)> per_type{};
+        AllocStats total;  // its peak is the sum of per type peaks, i.e. an upper bound of the real one
+
+        template<class Cls>
+        [[nodiscard]] const AllocStats &Get() const {
+            return per_type[IndexOf<Cls>()];
+        }
+
+        friend Snapshot operator-(Snapshot lhs, const Snapshot &rhs) noexcept {
+            for (size_t i = 0; i < sizeof...(C); ++i) {
+                lhs.per_type[i] -= rhs.per_type[i];
+            }
+            lhs.total -= rhs.total;
+            return lhs;
+        }
+    };
+
+    // Constructs the object in place, so objects which keep pointers to their own members are allowed
+    template<class Cls, class... Args, std::enable_if_t<(std::is_same_v<Cls, C> || ...), bool> = true>
+    Cls *New(Args &&... args) {
         Storage<Cls> &stg = std::get<Storage<Cls>>(storages_);
-        stg.AddElem(std::forward<Cls>(cls));
-        return stg.GetBackPointer();
+        return stg.Emplace(std::forward<Args>(args)...);
+    }
+
+    // Pool elements are constructed in place from the given args, e.g. Use from InstrArg
+    // Returns the object to the free list of its type, it must not be used after that
+    template<class Cls, std::enable_if_t<(std::is_same_v<Cls, C> || ...), bool> = true>
+    void Delete(Cls *obj) {
+        std::get<Storage<Cls>>(storages_).Recycle(obj);
+    }
+
+    template<class Cls, std::enable_if_t<(std::is_same_v<Cls, C> || ...), bool> = true>
+    [[nodiscard]] size_t GetFreeNum() const noexcept {
+        return std::get<Storage<Cls>>(storages_).GetFreeNum();
     }
 
     template<class T, class... Cls,
-            std::enable_if_t<(std::is_same_v<T, Cls> && ...), bool> = true,
+            std::enable_if_t<(std::is_constructible_v<T, Cls &&> && ...), bool> = true,
             std::enable_if_t<(std::is_same_v<T, C> || ...), bool> = true>
     std::vector<T *> NewPool(Cls &&... cls) {
         PoolStorage<T> &stg = std::get<PoolStorage<T>>(pool_storages_);
-        stg.AddPool(std::forward<T>(cls)...);
+        stg.AddPool(std::forward<Cls>(cls)...);
         return stg.GetBackPointersPool();
     }
 
@@ -142,9 +510,131 @@ public:
         return stg.template GetBackPointersPoolAsArray<sizeof...(Cls)>();
     }
 
+    // Single objects and pools of the type together
+    template<class Cls, std::enable_if_t<(std::is_same_v<Cls, C> || ...), bool> = true>
+    [[nodiscard]] AllocStats GetStats() const noexcept {
+        return std::get<Storage<Cls>>(storages_).GetStats() + std::get<PoolStorage<Cls>>(pool_storages_).GetStats();
+    }
+
+    [[nodiscard]] Snapshot TakeSnapshot() const noexcept {
+        Snapshot snapshot{{GetStats<C>()...}, {}};
+        for (const auto &stats: snapshot.per_type) {
+            snapshot.total += stats;
+        }
+        return snapshot;
+    }
+
+    template<class Cls, std::enable_if_t<(std::is_same_v<Cls, C> || ...), bool> = true>
+    Cls *GetById(size_t id) const {
+        return std::get<Storage<Cls>>(storages_).GetPointerById(id);
+    }
+
+    // All the allocated objects become invalid, memory is kept for reuse
+    void Reset() noexcept {
+        std::apply([](auto &... stg) { (stg.Reset(), ...); }, storages_);
+        std::apply([](auto &... stg) { (stg.Reset(), ...); }, pool_storages_);
+    }
+
+    // Looks up the object with given id among all storages of classes derived from Base
+    template<class Base>
+    Base *GetByIdAmong(size_t id) const {
+        Base *found = nullptr;
+        ((found = found != nullptr ? found : LookupAs<Base, C>(id)), ...);
+        return found;
+    }
+
+private:
+    template<class Cls>
+    static constexpr size_t IndexOf() {
+        constexpr std::array<bool, sizeof...(C)> matches{std::is_same_v<Cls, C>...};
+        size_t idx = 0;
+        while (idx < matches.size() && !matches[idx]) {
+            ++idx;
+        }
+        static_assert((std::is_same_v<Cls, C> || ...), "Type is not handled by the allocator");
+        return idx;
+    }
+
+    template<class Base, class Cls>
+    Base *LookupAs(size_t id) const {
+        if constexpr (std::is_base_of_v<Base, Cls>) {
+            return std::get<Storage<Cls>>(storages_).GetPointerById(id);
+        }
+        return nullptr;
+    }
+
+    std::tuple<Storage<C>...> storages_;
+    std::tuple<PoolStorage<C>...> pool_storages_;
+};
+
+/**
+ *  Keeps warm allocators for compile jobs: an allocator is reset when it is returned, so its slabs are
+ *  reused by the next job and steady-state compilation doesn't request memory from the system.
+ */
+template<class A>
+class AllocatorPool final {
+public:
+    // Returns the allocator to the pool when destroyed
+    class Lease final {
+    public:
+        Lease(AllocatorPool *pool, std::unique_ptr<A> alloc) : pool_(pool), alloc_(std::move(alloc)) {}
+
+        Lease(Lease &&) noexcept = default;
+        Lease &operator=(Lease &&) noexcept = default;
+
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+
+        ~Lease() {
+            if (alloc_ != nullptr) {
+                pool_->Release(std::move(alloc_));
+            }
+        }
+
+        A *Get() const noexcept {
+            return alloc_.get();
+        }
+
+        A *operator->() const noexcept {
+            return alloc_.get();
+        }
+
+    private:
+        AllocatorPool *pool_{nullptr};
+        std::unique_ptr<A> alloc_;
+    };
+
+    AllocatorPool() = default;
+
+    explicit AllocatorPool(size_t max_idle) : max_idle_(max_idle) {}
+
+    [[nodiscard]] Lease Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.empty()) {
+            return Lease{this, std::make_unique<A>()};
+        }
+        std::unique_ptr<A> alloc = std::move(idle_.back());
+        idle_.pop_back();
+        return Lease{this, std::move(alloc)};
+    }
+
+    [[nodiscard]] size_t GetIdleNum() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return idle_.size();
+    }
+
 private:
-    std::tuple<Storage<C>...> storages_ = std::make_tuple(Storage<C>{}...);
-    std::tuple<PoolStorage<C>...> pool_storages_ = std::make_tuple(PoolStorage<C>{}...);
+    void Release(std::unique_ptr<A> alloc) {
+        alloc->Reset();  // destructors are run outside of the lock
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_idle_) {
+            idle_.push_back(std::move(alloc));
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<A>> idle_;
+    size_t max_idle_{std::numeric_limits<size_t>::max()};
 };
 
 }  // namespace compiler::storage
@@ -0,0 +1,52 @@
+#ifndef COMPILER_ANALYSIS_H
+#define COMPILER_ANALYSIS_H
+
+#include <bitset>
+#include <cstdint>
+
+namespace compiler {
+
+// Results cached for the graph, see passes::AnalysisManager
+enum class Analysis : uint8_t {
+    RPO = 0,
+    DOM_TREE,
+    LOOP_INFO,
+    POST_DOM_TREE,
+    DOM_FRONTIER,
+    NUM
+};
+
+constexpr const size_t ANALYSES_NUM = static_cast<size_t>(Analysis::NUM);
+
+/**
+ *  Analyses which a pass keeps valid, the rest are invalidated after the pass. A pass which changes nothing
+ *  preserves all of them.
+ */
+class PreservedAnalyses final {
+public:
+    static PreservedAnalyses All() {
+        PreservedAnalyses preserved;
+        preserved.preserved_.set();
+        return preserved;
+    }
+
+    static PreservedAnalyses None() {
+        return {};
+    }
+
+    PreservedAnalyses &Preserve(Analysis analysis) {
+        preserved_.set(static_cast<size_t>(analysis));
+        return *this;
+    }
+
+    [[nodiscard]] bool IsPreserved(Analysis analysis) const {
+        return preserved_.test(static_cast<size_t>(analysis));
+    }
+
+private:
+    std::bitset<ANALYSES_NUM> preserved_;
+};
+
+}  // namespace compiler
+
+#endif //COMPILER_ANALYSIS_H
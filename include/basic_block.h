@@ -1,240 +1,337 @@
-#ifndef OPTIMIZER_BASICBLOCK_H
-#define OPTIMIZER_BASICBLOCK_H
-
-#include <set>
-
-#include "instruction.h"
-#include "marker.h"
-
-namespace compiler {
-
-class Graph;
-class Loop;
-
-class BasicBlock final {
-public:
-    BasicBlock() = default;
-
-    explicit BasicBlock(InstructionBase *first_instr, InstructionBase *last_instr) : first_instr_(first_instr),
-                                                                                     last_instr_(last_instr) {}
-
-    explicit BasicBlock(Graph *graph);
-
-    explicit BasicBlock(InstructionBase *first_instr, InstructionBase *last_instr, Graph *graph);
-
-    static BasicBlock MakeBasicBlock(const std::vector<InstructionBase *> &instrs);
-
-    static std::set<size_t> CollectIds(const BlocksVector &bbs);
-
-    void SetGraph(Graph *graph) {
-        graph_ = graph;
-    }
-
-    Graph *GetGraph() {
-        return graph_;
-    }
-
-    void SetFirstInstr(InstructionBase *first_instr) {
-        first_instr_ = first_instr;
-    }
-
-    InstructionBase *GetFirstInstr() {
-        return first_instr_;
-    }
-
-    void RemoveFirstInstr() {
-        if (first_instr_ == nullptr) {
-            std::cerr << "Warning! No instructions in basic block to remove." << std::endl;
-            return;
-        }
-        auto *new_first = first_instr_->GetNext();
-        if (new_first != nullptr) {
-            new_first->SetPrev(nullptr);
-        }
-        first_instr_->SetNext(nullptr);
-        first_instr_ = new_first;
-    }
-
-    void SetLastInstr(InstructionBase *last_instr) {
-        last_instr_ = last_instr;
-    }
-
-    InstructionBase *GetLastInstr() {
-        return last_instr_;
-    }
-
-    void RemoveLastInstr() {
-        if (last_instr_ == nullptr) {
-            std::cerr << "Warning! No instructions in basic block to remove." << std::endl;
-            return;
-        }
-        auto *new_last = last_instr_->GetPrev();
-        if (new_last != nullptr) {
-            new_last->SetNext(nullptr);
-        }
-        last_instr_->SetPrev(nullptr);
-        last_instr_ = new_last;
-    }
-
-    void RemoveInstr(InstructionBase *instr) {
-        assert(instr != nullptr);
-        assert(instr->GetBasicBlock() == this);
-        if (instr == first_instr_) {
-            RemoveFirstInstr();
-            return;
-        }
-        if (instr == last_instr_) {
-            RemoveLastInstr();
-            return;
-        }
-        auto *prev = instr->GetPrev();
-        auto *next = instr->GetNext();
-        prev->SetNext(next);
-        next->SetPrev(prev);
-    }
-
-    void SetFirstPhi(DynamicInputInstr *first_phi) {
-        first_phi_ = first_phi;
-    }
-
-    DynamicInputInstr *GetFirstPhi() {
-        return first_phi_;
-    }
-
-    void RemoveId() {
-        id_.reset();
-    }
-
-    void SetId(size_t id) {
-        id_ = id;
-    }
-
-    size_t GetId();
-
-    static void AddEdge(BasicBlock *lhs, BasicBlock *rhs) {
-        lhs->AddToSuccs({rhs});
-        rhs->AddToPreds({lhs});
-    }
-
-    void AddColor(const Marker::Color &c) {
-        marker_ |= c;
-    }
-
-    void RemoveColor(const Marker::Color &c) {
-        marker_ &= c;
-    }
-
-    [[nodiscard]] Marker GetMarker() const {
-        return marker_;
-    }
-
-    void AddToPreds(std::initializer_list<BasicBlock *> bbs) {
-        preds_.insert(preds_.end(), bbs.begin(), bbs.end());
-    }
-
-    void AddToPreds(std::vector<BasicBlock *> &&bbs) {
-        preds_ = std::forward<std::vector<BasicBlock *>>(bbs);
-    }
-
-    // Remove all predecessors from this block and add them to specified bb
-    void MovePreds(BasicBlock *bb) {
-        for (auto *pred : preds_) {
-            pred->RemoveFromSuccs(GetId());
-            pred->AddToSuccs({bb});
-        }
-        bb->AddToPreds(std::move(preds_));
-        preds_.clear();
-    }
-
-    void AddToSuccs(std::initializer_list<BasicBlock *> bbs) {
-        succs_.insert(succs_.end(), bbs.begin(), bbs.end());
-    }
-
-    void AddToSuccs(std::vector<BasicBlock *> &&bbs) {
-        succs_ = std::forward<std::vector<BasicBlock *>>(bbs);
-    }
-
-    // Remove all successors from this block and add them to specified bb
-    void MoveSuccs(BasicBlock *bb) {
-        for (auto *succ : succs_) {
-            succ->RemoveFromPreds(GetId());
-            succ->AddToPreds({bb});
-        }
-        bb->AddToSuccs(std::move(succs_));
-        succs_.clear();
-    }
-
-    void RemoveFromSuccs(size_t id);
-
-    void RemoveFromPreds(size_t id);
-
-    [[nodiscard]] BlocksVector GetPreds() const {
-        return preds_;
-    }
-
-    [[nodiscard]] BlocksVector GetSuccs() const {
-        return succs_;
-    }
-
-    void AddToDoms(std::initializer_list<BasicBlock *> bbs) {
-        dom_blocks_.insert(dom_blocks_.end(), bbs.begin(), bbs.end());
-    }
-
-    void SetImmDom(BasicBlock *bb) {
-        imm_dom_ = bb;
-    }
-
-    [[nodiscard]] BlocksVector GetDomBlocks() const {
-        return dom_blocks_;
-    }
-
-    BasicBlock *GetImmDom() {
-        return imm_dom_;
-    }
-
-    bool IsDominatedBy(BasicBlock *dom);
-
-    void SetLoop(Loop *loop) {
-        loop_ = loop;
-    }
-
-    Loop *GetLoop() {
-        return loop_;
-    }
-
-    bool IsLoopHeader() const;
-
-    InsnsVec GetAllInstrs();
-
-    // Splits this basic block on insn and returns second one bb
-    BasicBlock * SplitOn(InstructionBase *insn);
-
-    void InsertInstrBefore(InstructionBase *bb_instr, InstructionBase *instr);  // insert instr before bb_instr
-
-    void InsertInstrAfter(InstructionBase *bb_instr, InstructionBase *instr);  // insert instr after bb_instr
-
-    ~BasicBlock() = default;
-
-private:
-    Marker marker_;
-
-    std::optional<size_t> id_;
-
-    InstructionBase *first_instr_{nullptr};
-    InstructionBase *last_instr_{nullptr};
-    DynamicInputInstr *first_phi_{nullptr};
-
-    BlocksVector preds_;
-    BlocksVector succs_;
-
-    BlocksVector dom_blocks_;
-    BasicBlock *imm_dom_{nullptr};
-
-    Graph *graph_{nullptr};
-
-    Loop *loop_{nullptr};
-};
-
-}  // namespace compiler
-
-#endif //OPTIMIZER_BASICBLOCK_H
+#ifndef OPTIMIZER_BASICBLOCK_H
+#define OPTIMIZER_BASICBLOCK_H
+
+#include <set>
+#include <optional>
+
+#include "instruction.h"
+#include "marker.h"
+
+namespace compiler {
+
+class Graph;
+class Loop;
+
+struct NextInstr {
+    InstructionBase *operator()(const InstructionBase *instr) const {
+        return instr->GetNext();
+    }
+};
+
+struct SameInstr {
+    InstructionBase *operator()(InstructionBase *instr) const {
+        return instr;
+    }
+};
+
+// Instructions of a block from the first to the last one, the current instruction may be removed while iterating
+using InstrsRange = LinkedRange<InstructionBase, InstructionBase *, NextInstr, SameInstr>;
+
+class BasicBlock final {
+public:
+    BasicBlock() = default;
+
+    explicit BasicBlock(InstructionBase *first_instr, InstructionBase *last_instr) : first_instr_(first_instr),
+                                                                                     last_instr_(last_instr) {}
+
+    explicit BasicBlock(Graph *graph);
+
+    explicit BasicBlock(InstructionBase *first_instr, InstructionBase *last_instr, Graph *graph);
+
+    static BasicBlock MakeBasicBlock(const std::vector<InstructionBase *> &instrs);
+
+    static std::set<size_t> CollectIds(const BlocksVector &bbs);
+
+    // Instructions of the block get dense ids of the graph
+    void SetGraph(Graph *graph);
+
+    Graph *GetGraph() {
+        return graph_;
+    }
+
+    void SetFirstInstr(InstructionBase *first_instr) {
+        first_instr_ = first_instr;
+        instrs_order_valid_ = false;
+    }
+
+    InstructionBase *GetFirstInstr() {
+        return first_instr_;
+    }
+
+    void RemoveFirstInstr() {
+        if (first_instr_ == nullptr) {
+            std::cerr << "Warning! No instructions in basic block to remove." << std::endl;
+            return;
+        }
+        auto *new_first = first_instr_->GetNext();
+        if (new_first != nullptr) {
+            new_first->SetPrev(nullptr);
+        }
+        first_instr_->SetNext(nullptr);
+        first_instr_ = new_first;
+    }
+
+    void SetLastInstr(InstructionBase *last_instr) {
+        last_instr_ = last_instr;
+        instrs_order_valid_ = false;
+    }
+
+    InstructionBase *GetLastInstr() {
+        return last_instr_;
+    }
+
+    void RemoveLastInstr() {
+        if (last_instr_ == nullptr) {
+            std::cerr << "Warning! No instructions in basic block to remove." << std::endl;
+            return;
+        }
+        auto *new_last = last_instr_->GetPrev();
+        if (new_last != nullptr) {
+            new_last->SetNext(nullptr);
+        }
+        last_instr_->SetPrev(nullptr);
+        last_instr_ = new_last;
+    }
+
+    void RemoveInstr(InstructionBase *instr) {
+        assert(instr != nullptr);
+        assert(instr->GetBasicBlock() == this);
+        if (instr == first_instr_) {
+            RemoveFirstInstr();
+            return;
+        }
+        if (instr == last_instr_) {
+            RemoveLastInstr();
+            return;
+        }
+        auto *prev = instr->GetPrev();
+        auto *next = instr->GetNext();
+        prev->SetNext(next);
+        next->SetPrev(prev);
+    }
+
+    // Remove the instruction from the block and the data flow and recycle its memory
+    void EraseInstr(InstructionBase *instr);
+
+    /**
+     *  Numbers the instructions if the order is lost. Numbers are given with gaps, so an instruction inserted
+     *  by InsertInstrBefore/After usually takes a number between its neighbours and the block isn't renumbered.
+     *  Removal keeps the order of the rest instructions, so it doesn't invalidate the numbers.
+     */
+    void UpdateInstrsOrder() {
+        if (!instrs_order_valid_) {
+            RenumberInstrs();
+        }
+    }
+
+    void SetFirstPhi(DynamicInputInstr *first_phi) {
+        first_phi_ = first_phi;
+    }
+
+    DynamicInputInstr *GetFirstPhi() {
+        return first_phi_;
+    }
+
+    void RemoveId() {
+        id_.reset();
+    }
+
+    void SetId(size_t id) {
+        id_ = id;
+    }
+
+    size_t GetId();
+
+    [[nodiscard]] bool HasId() const noexcept {
+        return id_.has_value();
+    }
+
+    void SetHandle(BlockHandle handle) noexcept {
+        handle_ = handle;
+    }
+
+    // Valid only after the handles are built by the graph, see Graph::BuildHandles
+    [[nodiscard]] BlockHandle GetHandle() const noexcept {
+        return handle_;
+    }
+
+    static void AddEdge(BasicBlock *lhs, BasicBlock *rhs) {
+        lhs->AddToSuccs({rhs});
+        rhs->AddToPreds({lhs});
+    }
+
+    void SetMarker(Marker marker) {
+        markers_.Set(marker);
+    }
+
+    void ResetMarker(Marker marker) {
+        markers_.Reset(marker);
+    }
+
+    [[nodiscard]] bool IsMarked(Marker marker) const {
+        return markers_.IsSet(marker);
+    }
+
+    void AddToPreds(std::initializer_list<BasicBlock *> bbs) {
+        preds_.insert(preds_.end(), bbs.begin(), bbs.end());
+    }
+
+    void AddToPreds(std::vector<BasicBlock *> &&bbs) {
+        preds_ = std::forward<std::vector<BasicBlock *>>(bbs);
+    }
+
+    // Remove all predecessors from this block and add them to specified bb
+    void MovePreds(BasicBlock *bb) {
+        for (auto *pred : preds_) {
+            pred->RemoveFromSuccs(GetId());
+            pred->AddToSuccs({bb});
+        }
+        bb->AddToPreds(std::move(preds_));
+        preds_.clear();
+    }
+
+    void AddToSuccs(std::initializer_list<BasicBlock *> bbs) {
+        succs_.insert(succs_.end(), bbs.begin(), bbs.end());
+        InvalidateCfgOrder();
+    }
+
+    void AddToSuccs(std::vector<BasicBlock *> &&bbs) {
+        succs_ = std::forward<std::vector<BasicBlock *>>(bbs);
+        InvalidateCfgOrder();
+    }
+
+    // Remove all successors from this block and add them to specified bb
+    void MoveSuccs(BasicBlock *bb) {
+        for (auto *succ : succs_) {
+            succ->RemoveFromPreds(GetId());
+            succ->AddToPreds({bb});
+        }
+        bb->AddToSuccs(std::move(succs_));
+        succs_.clear();
+    }
+
+    void RemoveFromSuccs(size_t id);
+
+    // The edge to old_succ goes to new_succ now, position of the successor (i.e. the branch) is kept
+    void ReplaceSucc(BasicBlock *old_succ, BasicBlock *new_succ);
+
+    void RemoveFromPreds(size_t id);
+
+    [[nodiscard]] Span<BasicBlock *> GetPreds() const {
+        return preds_;
+    }
+
+    [[nodiscard]] Span<BasicBlock *> GetSuccs() const {
+        return succs_;
+    }
+
+    void SetImmDom(BasicBlock *bb) {
+        imm_dom_ = bb;
+    }
+
+    // Computed on demand from the chain of immediate dominators: all the strict dominators, the root for the root
+    [[nodiscard]] BlocksVector GetDomBlocks() const;
+
+    BasicBlock *GetImmDom() {
+        return imm_dom_;
+    }
+
+    void AddDomChild(BasicBlock *bb) {
+        dom_children_.push_back(bb);
+    }
+
+    // Blocks immediately dominated by this one
+    [[nodiscard]] Span<BasicBlock *> GetDomChildren() const {
+        return dom_children_;
+    }
+
+    // Drops the result of the previous dominator tree building
+    void ClearDomInfo() {
+        dom_children_.clear();
+        imm_dom_ = nullptr;
+        dom_pre_ = 0;
+        dom_post_ = 0;
+    }
+
+    // Entry and exit numbers of the block in the DFS of the dominator tree, 0 means the block isn't numbered
+    void SetDomNumbers(uint32_t pre, uint32_t post) {
+        dom_pre_ = pre;
+        dom_post_ = post;
+    }
+
+    /**
+     *  Constant time: the dominated block is in the subtree of its dominator in the dominator tree, so its
+     *  DFS interval is inside the dominator's one. A block dominates itself.
+     */
+    [[nodiscard]] bool IsDominatedBy(const BasicBlock *dom) const {
+        assert(dom != nullptr);
+        return dom_pre_ != 0 && dom->dom_pre_ <= dom_pre_ && dom_post_ <= dom->dom_post_;
+    }
+
+    void SetLoop(Loop *loop) {
+        loop_ = loop;
+    }
+
+    Loop *GetLoop() {
+        return loop_;
+    }
+
+    bool IsLoopHeader() const;
+
+    // Depth of the innermost loop containing the block, 0 for the blocks outside of loops
+    [[nodiscard]] uint32_t GetLoopDepth() const;
+
+    [[nodiscard]] InstrsRange GetInstrs() const {
+        return InstrsRange{first_instr_};
+    }
+
+    // Copy of the instructions list, prefer GetInstrs() if the list is only iterated
+    InsnsVec GetAllInstrs();
+
+    // Splits this basic block on insn and returns second one bb, the valid loop tree is updated
+    BasicBlock * SplitOn(InstructionBase *insn);
+
+    void InsertInstrBefore(InstructionBase *bb_instr, InstructionBase *instr);  // insert instr before bb_instr
+
+    void InsertInstrAfter(InstructionBase *bb_instr, InstructionBase *instr);  // insert instr after bb_instr
+
+    ~BasicBlock() = default;
+
+private:
+    // Successors are changed, so the cached walk of the graph is stale
+    void InvalidateCfgOrder();
+
+    void RenumberInstrs();
+
+    // Gives the just linked instruction the number between its neighbours, if there is no gap the block is
+    // renumbered lazily
+    void AssignOrder(InstructionBase *instr);
+
+    static constexpr uint32_t INSTR_ORDER_STEP = 1U << 8;
+
+    MarkerStamps markers_;
+
+    std::optional<size_t> id_;
+    BlockHandle handle_;
+
+    InstructionBase *first_instr_{nullptr};
+    InstructionBase *last_instr_{nullptr};
+    bool instrs_order_valid_{false};
+    DynamicInputInstr *first_phi_{nullptr};
+
+    BlocksVector preds_;
+    BlocksVector succs_;
+
+    BlocksVector dom_children_;
+    BasicBlock *imm_dom_{nullptr};
+    uint32_t dom_pre_{0};
+    uint32_t dom_post_{0};
+
+    Graph *graph_{nullptr};
+
+    Loop *loop_{nullptr};
+};
+
+}  // namespace compiler
+
+#endif //OPTIMIZER_BASICBLOCK_H
@@ -1,155 +1,175 @@
-#ifndef OPTIMIZER_COMMON_H
-#define OPTIMIZER_COMMON_H
-
-#include <cstdint>
-#include <iostream>
-#include <type_traits>
-#include <cassert>
-
-#include "allocator.h"
-
-namespace compiler {
-
-class InstrArg;
-
-class InstructionBase;
-class DynamicInputInstr;
-class ZeroInputInstr;
-class OneInputInstr;
-class TwoInputInstr;
-class ThreeInputInstr;
-
-class BasicBlock;
-
-using Allocator = storage::Allocator<BasicBlock, InstrArg, DynamicInputInstr, ZeroInputInstr,
-        OneInputInstr, TwoInputInstr, ThreeInputInstr>;
-
-class InstructionBase;
-
-class Graph;
-
-using vreg_t = uint16_t;
-using BlocksVector = std::vector<BasicBlock *>;
-using InsnsVec = std::vector<InstructionBase *>;
-
-enum class Opcode : uint8_t {
-    NONE,
-    NOP,
-    NULL_CHECK,
-    ZERO_CHECK,
-    BOUNDS_CHECK,
-    PHI,
-    CAST,
-    STA,
-    NEW_ARRAY,
-    LEN_ARRAY,
-    LOAD_ARRAY,
-    CONSTANT,
-    PARAMETER,
-    ADDI,
-    ADD,
-    SUBI,
-    SUB,
-    MULI,
-    MUL,
-    MOVI,
-    MOV,
-    CMP,
-    JA,
-    JAE,
-    JG,
-    JGE,
-    JB,
-    JBE,
-    JL,
-    JLE,
-    JE,
-    JNE,
-    JO,
-    JMP,
-    CALL,
-    RET,
-    RET_VOID,
-    THROW
-};
-
-enum class InstrType : uint8_t {
-    U8,
-    U16,
-    U32,
-    U64,
-    I8,
-    I16,
-    I32,
-    I64
-};
-
-class InstrArg {
-public:
-    /**
-     * The Type enum represents the type of argument that is constructing.
-     * For `a` and `v` types: `num` means num of a register.
-     * For `imm` type: `num` means the value of immediate.
-     * For `id` type: `num` means the instruction id that corresponds to the target or def instr; or
-     *              : `num` means the graph id that corresponds to the callee graph
-     */
-    enum Type {
-        acc, a, v, imm, id, callee_graph, none  // acc - accumulator, a - func parameter, v - virtual reg
-    };
-
-    InstrArg(InstructionBase *ref = nullptr) : type_(Type::acc), ref_(ref) {}  // For accumulator register only
-
-    InstrArg(Type type, vreg_t num, InstructionBase *ref = nullptr);  // ref = target or def
-
-    InstrArg(vreg_t num, Graph *graph) : type_(Type::callee_graph), num_(num), callee_(graph) {}
-
-    [[nodiscard]] vreg_t num() const {
-        return num_;
-    }
-
-    [[nodiscard]] Type type() const {
-        return type_;
-    }
-
-    [[nodiscard]] InstructionBase *target() const {
-        assert(type_ == Type::id);
-        return ref_;
-    }
-
-    [[nodiscard]] Graph *callee() const {
-        assert(type_ == Type::callee_graph);
-        return callee_;
-    }
-
-    [[nodiscard]] InstructionBase *def() const {
-        assert(type_ == Type::a || type_ == Type::v || type_ == Type::imm || type_ == Type::acc);
-        return ref_;
-    }
-
-    void SetDef(InstructionBase *def) {
-        ref_ = def;
-    }
-
-    bool operator==(const InstrArg &arg) const {
-        return type_ == arg.type_ && num_ == arg.num_ && ref_ == arg.ref_ && callee_ == arg.callee_;
-    }
-
-private:
-    Type type_;
-    size_t num_{};  // number of virtual register, or the value of immediate, or the Instruction id of target
-    InstructionBase *ref_{nullptr};  // target instruction to which the jump will happen; or a definition for this input
-    Graph *callee_{nullptr};  // callee graph in case if instruction itself is call
-};
-
-// The specialized hash function for `unordered_map` keys
-struct hash_instr_arg {
-    std::size_t operator()(const InstrArg &arg) const {
-        std::size_t h1 = std::hash<vreg_t>()(arg.num());
-        std::size_t h2 = std::hash<size_t>()(arg.type());
-        return h1 ^ h2;
-    }
-};
-
-}  // namespace compiler
-
-#endif //OPTIMIZER_COMMON_H
+#ifndef OPTIMIZER_COMMON_H
+#define OPTIMIZER_COMMON_H
+
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+#include <cassert>
+
+#include "allocator.h"
+#include "handle.h"
+
+namespace compiler {
+
+class InstrArg;
+class Use;
+
+class InstructionBase;
+class DynamicInputInstr;
+class ZeroInputInstr;
+class OneInputInstr;
+class TwoInputInstr;
+class ThreeInputInstr;
+
+class BasicBlock;
+
+using Allocator = storage::Allocator<BasicBlock, InstrArg, Use, DynamicInputInstr, ZeroInputInstr,
+        OneInputInstr, TwoInputInstr, ThreeInputInstr>;
+
+using AllocatorPool = storage::AllocatorPool<Allocator>;
+
+class InstructionBase;
+
+class Graph;
+
+using InstrHandle = Handle<InstructionBase>;
+using BlockHandle = Handle<BasicBlock>;
+
+using vreg_t = uint16_t;
+using BlocksVector = std::vector<BasicBlock *>;
+using InsnsVec = std::vector<InstructionBase *>;
+
+enum class Opcode : uint8_t {
+    NONE,
+    NOP,
+    NULL_CHECK,
+    ZERO_CHECK,
+    BOUNDS_CHECK,
+    PHI,
+    CAST,
+    STA,
+    NEW_ARRAY,
+    LEN_ARRAY,
+    LOAD_ARRAY,
+    CONSTANT,
+    PARAMETER,
+    ADDI,
+    ADD,
+    SUBI,
+    SUB,
+    MULI,
+    MUL,
+    MOVI,
+    MOV,
+    CMP,
+    JA,
+    JAE,
+    JG,
+    JGE,
+    JB,
+    JBE,
+    JL,
+    JLE,
+    JE,
+    JNE,
+    JO,
+    JMP,
+    CALL,
+    RET,
+    RET_VOID,
+    THROW
+};
+
+enum class InstrType : uint8_t {
+    U8,
+    U16,
+    U32,
+    U64,
+    I8,
+    I16,
+    I32,
+    I64
+};
+
+class InstrArg {
+public:
+    /**
+     * The Type enum represents the type of argument that is constructing.
+     * For `a` and `v` types: `num` means num of a register.
+     * For `imm` type: `num` means the value of immediate.
+     * For `id` type: `num` means the instruction id that corresponds to the target or def instr; or
+     *              : `num` means the graph id that corresponds to the callee graph
+     */
+    enum Type : uint8_t {
+        acc, a, v, imm, id, callee_graph, none  // acc - accumulator, a - func parameter, v - virtual reg
+    };
+
+    InstrArg(InstructionBase *ref = nullptr) : ref_(ref), type_(Type::acc) {}  // For accumulator register only
+
+    InstrArg(Type type, vreg_t num, InstructionBase *ref = nullptr);  // ref = target or def
+
+    InstrArg(vreg_t num, Graph *graph) : callee_(graph), num_(num), type_(Type::callee_graph) {}
+
+    [[nodiscard]] vreg_t num() const {
+        return num_;
+    }
+
+    [[nodiscard]] Type type() const {
+        return type_;
+    }
+
+    [[nodiscard]] InstructionBase *target() const {
+        assert(type_ == Type::id);
+        return ref_;
+    }
+
+    [[nodiscard]] Graph *callee() const {
+        assert(type_ == Type::callee_graph);
+        return callee_;
+    }
+
+    [[nodiscard]] InstructionBase *def() const {
+        assert(type_ == Type::a || type_ == Type::v || type_ == Type::imm || type_ == Type::acc);
+        return ref_;
+    }
+
+    void SetDef(InstructionBase *def) {
+        ref_ = def;
+    }
+
+    // Whether the arg is an edge of the data flow, i.e. def() may be called for it
+    [[nodiscard]] bool IsDataFlow() const {
+        return type_ == Type::a || type_ == Type::v || type_ == Type::imm || type_ == Type::acc;
+    }
+
+    bool operator==(const InstrArg &arg) const {
+        if (type_ != arg.type_ || num_ != arg.num_) {
+            return false;
+        }
+        return type_ == Type::callee_graph ? callee_ == arg.callee_ : ref_ == arg.ref_;
+    }
+
+private:
+    // Packed into 16 bytes: the pointer, then the payload and the tag, so 4 args fit in a cache line
+    union {
+        InstructionBase *ref_;  // target instruction to which the jump will happen; or a definition for this input
+        Graph *callee_;  // callee graph in case if instruction itself is call
+    };
+    uint32_t num_{};  // number of virtual register, or the value of immediate, or the Instruction id of target
+    Type type_;
+};
+
+static_assert(sizeof(InstrArg) == 16, "InstrArg is expected to be packed into 16 bytes");
+
+// The specialized hash function for `unordered_map` keys
+struct hash_instr_arg {
+    std::size_t operator()(const InstrArg &arg) const {
+        std::size_t h1 = std::hash<vreg_t>()(arg.num());
+        std::size_t h2 = std::hash<size_t>()(arg.type());
+        return h1 ^ h2;
+    }
+};
+
+}  // namespace compiler
+
+#endif //OPTIMIZER_COMMON_H
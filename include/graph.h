@@ -1,154 +1,364 @@
-#ifndef OPTIMIZER_GRAPH_H
-#define OPTIMIZER_GRAPH_H
-
-#include <unordered_map>
-#include <map>
-#include <optional>
-#include <cassert>
-
-#include "basic_block.h"
-
-namespace compiler {
-
-class BasicBlock;
-class Traversal;
-
-class Graph final {
-public:
-    Graph(Allocator *alloc) : allocator_(alloc) {}
-    explicit Graph(Allocator *alloc, BasicBlock *root, BasicBlock *end, uint8_t params_num) :
-                    allocator_(alloc), root_(root), end_(end), params_num_(params_num), blocks_num_{2} {
-        root->SetId(0);
-        end->SetId(1);
-    }
-
-    Allocator *GetAllocator() {
-        return allocator_;
-    }
-
-    void SetRoot(BasicBlock *root) {
-        root->SetId(0);
-        root_ = root;
-        ++blocks_num_;
-    }
-
-    BasicBlock *GetRoot() {
-        return root_;
-    }
-
-    void MoveRoot(BasicBlock *new_root) {
-        BasicBlock::AddEdge(new_root, root_);
-        SetGraphForBasicBlocks({new_root});
-        root_ = new_root;
-    }
-
-    void SetEnd(BasicBlock *end) {
-        end->SetId(1);
-        end_ = end;
-        ++blocks_num_;
-    }
-
-    BasicBlock *GetEnd() {
-        return end_;
-    }
-
-    BasicBlock *FindBlock(size_t id);
-
-    void SetGraphForBasicBlocks(std::initializer_list<BasicBlock *> bbs);
-
-    BasicBlock *RemoveBlock(size_t id);
-
-    void RestoreBlock(BasicBlock *bb);
-
-    bool IsRpoValid() const noexcept {
-        return rpo_valid_;
-    }
-
-    void MakeRpoValid() noexcept {
-        rpo_valid_ = true;
-    }
-
-    void InvalidateRpo() noexcept {
-        rpo_valid_ = false;
-    }
-
-    void SetParamsNum(uint8_t params_num) noexcept {
-        params_num_ = params_num;
-    }
-
-    uint8_t GetParamsNum() const noexcept {
-        return params_num_;
-    }
-
-    void IncreaseBlocksNum() noexcept {
-        ++blocks_num_;
-    }
-
-    void IncreaseBlocksNumOn(uint16_t count) noexcept {
-        blocks_num_ += count;
-    }
-
-    size_t GetBlocksNum() const noexcept {
-        return blocks_num_;
-    }
-
-    static size_t GenInstrId() noexcept {
-        return instrs_count_++;
-    }
-
-    bool IsDomTreeValid() const noexcept {
-        return dom_tree_valid_;
-    }
-
-    void MakeDomTreeValid() noexcept {
-        dom_tree_valid_ = true;
-    }
-
-    void InvalidateDomTree() noexcept {
-        dom_tree_valid_ = false;
-    }
-
-    bool IsLoopAnalysisValid() const noexcept {
-        return loop_analysis_valid_;
-    }
-
-    void MakeLoopAnalysisValid() noexcept {
-        loop_analysis_valid_ = true;
-    }
-
-    void InvalidateLoopAnalysis() noexcept {
-        loop_analysis_valid_ = false;
-    }
-
-    Loop *GetRootLoop() noexcept {
-        assert(loop_analysis_valid_);
-        return root_->GetLoop();
-    }
-
-    void AddLabel(const std::string &label);
-
-    std::optional<size_t> GetLabelId(const std::string &label);
-
-    void AddTarget(const std::string &label, InstructionBase *instr);
-
-    std::optional<InstructionBase *> GetTargetInstr(const std::string &label);
-
-private:
-    Allocator *allocator_;
-
-    BasicBlock *root_;
-    BasicBlock *end_;
-    uint8_t params_num_;
-    size_t blocks_num_{0};
-    static size_t instrs_count_;
-    std::unordered_map<std::string, size_t> label_table_;
-    std::unordered_map<std::string, InstructionBase *> jump_table_;
-
-    bool rpo_valid_{false};
-    bool dom_tree_valid_{false};
-    bool loop_analysis_valid_{false};
-};
-
-}  // namespace compiler
-
-#endif //OPTIMIZER_GRAPH_H
+#ifndef OPTIMIZER_GRAPH_H
+#define OPTIMIZER_GRAPH_H
+
+#include <unordered_map>
+#include <map>
+#include <optional>
+#include <atomic>
+#include <memory>
+#include <cassert>
+
+#include "basic_block.h"
+#include "analysis.h"
+
+namespace compiler {
+
+class BasicBlock;
+class Traversal;
+class Loop;
+
+namespace passes {
+class AnalysisManager;
+}  // namespace passes
+
+// Owner of the analysis manager of a graph, the copy of the graph starts without the cached results
+class AnalysisManagerHolder final {
+public:
+    // Defined where the manager is complete
+    AnalysisManagerHolder();
+
+    AnalysisManagerHolder(const AnalysisManagerHolder &);
+
+    AnalysisManagerHolder &operator=(const AnalysisManagerHolder &);
+
+    ~AnalysisManagerHolder();
+
+    passes::AnalysisManager &Get(Graph *graph);
+
+private:
+    std::unique_ptr<passes::AnalysisManager> manager_;
+};
+
+/**
+ *  Arena of the loops of a graph. Loops are never relocated, so the blocks and the loop tree may keep pointers
+ *  to them until the loop analysis is rerun. The copy of the graph starts without loops.
+ */
+class LoopsHolder final {
+public:
+    // Defined where the loop is complete
+    LoopsHolder();
+
+    LoopsHolder(const LoopsHolder &);
+
+    LoopsHolder &operator=(const LoopsHolder &);
+
+    ~LoopsHolder();
+
+    // The loop gets the next id, the header isn't added to the loop blocks
+    Loop *New(BasicBlock *header);
+
+    // All the loops are destroyed and ids start from 0, the memory is kept for the next analysis
+    void Clear();
+
+    [[nodiscard]] size_t GetLoopsNum() const noexcept {
+        return loops_num_;
+    }
+
+private:
+    storage::Arena<Loop> loops_;
+    size_t loops_num_{0};
+};
+
+// Ids of instructions which aren't attached to any graph yet, they never clash with the dense ids of graphs
+constexpr size_t DETACHED_INSTR_ID_BASE = size_t{1} << 32;
+
+class Graph final {
+public:
+    Graph(Allocator *alloc) : allocator_(alloc) {}
+    explicit Graph(Allocator *alloc, BasicBlock *root, BasicBlock *end, uint8_t params_num) :
+                    allocator_(alloc), root_(root), end_(end), params_num_(params_num), blocks_num_{2} {
+        SetBlockId(root, 0);
+        SetBlockId(end, 1);
+    }
+
+    Allocator *GetAllocator() {
+        return allocator_;
+    }
+
+    void SetRoot(BasicBlock *root) {
+        SetBlockId(root, 0);
+        root_ = root;
+        ++blocks_num_;
+    }
+
+    BasicBlock *GetRoot() {
+        return root_;
+    }
+
+    void MoveRoot(BasicBlock *new_root) {
+        BasicBlock::AddEdge(new_root, root_);
+        SetGraphForBasicBlocks({new_root});
+        root_ = new_root;
+    }
+
+    void SetEnd(BasicBlock *end) {
+        SetBlockId(end, 1);
+        end_ = end;
+        ++blocks_num_;
+    }
+
+    BasicBlock *GetEnd() {
+        return end_;
+    }
+
+    // Constant time lookup in the block table, blocks which haven't got their ids yet are numbered by a traversal
+    BasicBlock *FindBlock(size_t id);
+
+    // Gives the block the next id of this graph and puts it to the block table
+    size_t GenBlockId(BasicBlock *bb);
+
+    /**
+     *  Renumbers the reachable blocks densely: root gets 0, end gets 1 and the others follow in RPO.
+     *  Ids of removed blocks are reused, so side tables indexed by block id must be rebuilt after that.
+     */
+    void CompactBlockIds();
+
+    // Constant time lookup by the dense id, nullptr if the instruction was erased or moved to another graph
+    InstructionBase *FindInstr(size_t id) const;
+
+    // Gives the instruction the next dense id of this graph unless it is already registered here
+    void AddInstr(InstructionBase *instr);
+
+    void RemoveInstr(InstructionBase *instr);
+
+    [[nodiscard]] bool IsInstrRegistered(const InstructionBase *instr) const {
+        size_t id = instr->GetId();
+        return id < instrs_by_id_.size() && instrs_by_id_[id] == instr;
+    }
+
+    // Upper bound of the instruction ids, size of a flat table indexed by them
+    [[nodiscard]] size_t GetInstrIdsNum() const noexcept {
+        return instrs_by_id_.size();
+    }
+
+    // Handle mode: assigns dense 32-bit handles to all the reachable blocks (in RPO) and their instructions
+    void BuildHandles();
+
+    [[nodiscard]] bool HasHandles() const noexcept {
+        return block_handles_.Size() != 0;
+    }
+
+    BlockHandle RegisterBlock(BasicBlock *bb) {
+        bb->SetHandle(block_handles_.Register(bb));
+        return bb->GetHandle();
+    }
+
+    InstrHandle RegisterInstr(InstructionBase *instr) {
+        instr->SetHandle(instr_handles_.Register(instr));
+        return instr->GetHandle();
+    }
+
+    [[nodiscard]] BasicBlock *GetBlock(BlockHandle handle) const {
+        return block_handles_.Get(handle);
+    }
+
+    [[nodiscard]] InstructionBase *GetInstr(InstrHandle handle) const {
+        return instr_handles_.Get(handle);
+    }
+
+    // Invalid handle is returned for an entity that isn't registered in this graph
+    [[nodiscard]] BlockHandle GetHandle(const BasicBlock *bb) const {
+        return GetBlock(bb->GetHandle()) == bb ? bb->GetHandle() : BlockHandle{};
+    }
+
+    [[nodiscard]] InstrHandle GetHandle(const InstructionBase *instr) const {
+        return GetInstr(instr->GetHandle()) == instr ? instr->GetHandle() : InstrHandle{};
+    }
+
+    [[nodiscard]] size_t GetBlockHandlesNum() const noexcept {
+        return block_handles_.Size();
+    }
+
+    [[nodiscard]] size_t GetInstrHandlesNum() const noexcept {
+        return instr_handles_.Size();
+    }
+
+    void SetGraphForBasicBlocks(std::initializer_list<BasicBlock *> bbs);
+
+    BasicBlock *RemoveBlock(size_t id);
+
+    void RestoreBlock(BasicBlock *bb);
+
+    [[nodiscard]] bool IsAnalysisValid(Analysis analysis) const noexcept {
+        return valid_analyses_.test(static_cast<size_t>(analysis));
+    }
+
+    void MakeAnalysisValid(Analysis analysis) noexcept {
+        valid_analyses_.set(static_cast<size_t>(analysis));
+    }
+
+    // Drops the analyses which aren't preserved and the ones computed from them
+    void InvalidateAnalyses(const PreservedAnalyses &preserved);
+
+    // Analyses are computed on the first request and cached until they are invalidated
+    passes::AnalysisManager &GetAnalyses() {
+        return analysis_manager_.Get(this);
+    }
+
+    bool IsRpoValid() const noexcept {
+        return IsAnalysisValid(Analysis::RPO);
+    }
+
+    void MakeRpoValid() noexcept {
+        MakeAnalysisValid(Analysis::RPO);
+    }
+
+    // CFG is changed, so the analyses computed by the walks of the CFG are stale too
+    void InvalidateRpo() noexcept {
+        for (auto analysis: {Analysis::RPO, Analysis::POST_DOM_TREE, Analysis::DOM_FRONTIER}) {
+            valid_analyses_.reset(static_cast<size_t>(analysis));
+        }
+    }
+
+    // Result of the last walk, see passes::Traversal
+    void SetDfsOrder(BlocksVector &&dfs_blocks) {
+        dfs_blocks_ = std::move(dfs_blocks);
+        rpo_blocks_.assign(dfs_blocks_.rbegin(), dfs_blocks_.rend());
+        MakeRpoValid();
+    }
+
+    [[nodiscard]] const BlocksVector &GetDfsOrder() const noexcept {
+        return dfs_blocks_;
+    }
+
+    [[nodiscard]] const BlocksVector &GetRpoOrder() const noexcept {
+        return rpo_blocks_;
+    }
+
+    void SetParamsNum(uint8_t params_num) noexcept {
+        params_num_ = params_num;
+    }
+
+    uint8_t GetParamsNum() const noexcept {
+        return params_num_;
+    }
+
+    void IncreaseBlocksNum() noexcept {
+        ++blocks_num_;
+    }
+
+    void IncreaseBlocksNumOn(uint16_t count) noexcept {
+        blocks_num_ += count;
+    }
+
+    size_t GetBlocksNum() const noexcept {
+        return blocks_num_;
+    }
+
+    // Upper bound of the block ids, size of a flat table indexed by them
+    [[nodiscard]] size_t GetBlockIdsNum() const noexcept {
+        return blocks_by_id_.size();
+    }
+
+    // Dense ids are generated by the graph which owns the instructions, so the graph must be modified by
+    // one thread at a time, but different graphs may be built and compiled concurrently
+    size_t GenInstrId() noexcept {
+        return instrs_by_id_.size();
+    }
+
+    // Temporary id of an instruction until it is added to a graph
+    static size_t GenDetachedInstrId() noexcept {
+        return DETACHED_INSTR_ID_BASE + detached_instrs_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool IsDomTreeValid() const noexcept {
+        return IsAnalysisValid(Analysis::DOM_TREE);
+    }
+
+    void MakeDomTreeValid() noexcept {
+        MakeAnalysisValid(Analysis::DOM_TREE);
+    }
+
+    // Frontiers are computed from the tree
+    void InvalidateDomTree() noexcept {
+        valid_analyses_.reset(static_cast<size_t>(Analysis::DOM_TREE));
+        valid_analyses_.reset(static_cast<size_t>(Analysis::DOM_FRONTIER));
+    }
+
+    bool IsLoopAnalysisValid() const noexcept {
+        return IsAnalysisValid(Analysis::LOOP_INFO);
+    }
+
+    void MakeLoopAnalysisValid() noexcept {
+        MakeAnalysisValid(Analysis::LOOP_INFO);
+    }
+
+    void InvalidateLoopAnalysis() noexcept {
+        valid_analyses_.reset(static_cast<size_t>(Analysis::LOOP_INFO));
+    }
+
+    Loop *GetRootLoop() noexcept {
+        assert(IsLoopAnalysisValid());
+        return root_->GetLoop();
+    }
+
+    Loop *NewLoop(BasicBlock *header) {
+        return loops_.New(header);
+    }
+
+    // Loops of the previous analysis are dead after that, the blocks mustn't refer to them
+    void ClearLoops() {
+        loops_.Clear();
+    }
+
+    [[nodiscard]] size_t GetLoopsNum() const noexcept {
+        return loops_.GetLoopsNum();
+    }
+
+    // Every call gives a marker which no entity is marked with, it must be erased when it is not needed anymore
+    Marker NewMarker();
+
+    void EraseMarker(Marker marker);
+
+    void AddLabel(const std::string &label);
+
+    std::optional<size_t> GetLabelId(const std::string &label);
+
+    void AddTarget(const std::string &label, InstructionBase *instr);
+
+    std::optional<InstructionBase *> GetTargetInstr(const std::string &label);
+
+private:
+    void SetBlockId(BasicBlock *bb, size_t id);
+
+    [[nodiscard]] BasicBlock *LookupBlock(size_t id) const;
+
+    Allocator *allocator_;
+
+    BasicBlock *root_;
+    BasicBlock *end_;
+    uint8_t params_num_;
+    size_t blocks_num_{0};
+    static std::atomic<size_t> detached_instrs_count_;
+    std::vector<InstructionBase *> instrs_by_id_;  // indexed by the dense id, erased ones are nullptr
+    std::vector<BasicBlock *> blocks_by_id_;  // indexed by the block id, holes are nullptr
+
+    // Epochs are shared by all the graphs, so stamps of blocks moved from another graph don't match
+    static std::atomic<uint32_t> markers_epoch_;
+    std::array<bool, MAX_MARKERS_NUM> used_marker_slots_{};
+    std::unordered_map<std::string, size_t> label_table_;
+    std::unordered_map<std::string, InstructionBase *> jump_table_;
+
+    HandleTable<BasicBlock> block_handles_;
+    HandleTable<InstructionBase> instr_handles_;
+
+    BlocksVector dfs_blocks_;
+    BlocksVector rpo_blocks_;
+    std::bitset<ANALYSES_NUM> valid_analyses_;
+    AnalysisManagerHolder analysis_manager_;
+    LoopsHolder loops_;
+};
+
+}  // namespace compiler
+
+#endif //OPTIMIZER_GRAPH_H
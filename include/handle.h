@@ -0,0 +1,78 @@
+#ifndef COMPILER_HANDLE_H
+#define COMPILER_HANDLE_H
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cassert>
+
+namespace compiler {
+
+/**
+ *  32-bit index of a graph entity in the per-graph handle table. Unlike the pointer it stays the same
+ *  after the graph is relocated or serialized, and takes half of the memory in link-heavy structures.
+ */
+template<class T>
+class Handle final {
+public:
+    static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+    Handle() = default;
+
+    explicit Handle(uint32_t idx) : idx_(idx) {}
+
+    [[nodiscard]] uint32_t GetIndex() const noexcept {
+        return idx_;
+    }
+
+    [[nodiscard]] bool IsValid() const noexcept {
+        return idx_ != INVALID_INDEX;
+    }
+
+    bool operator==(const Handle &other) const noexcept {
+        return idx_ == other.idx_;
+    }
+
+    bool operator!=(const Handle &other) const noexcept {
+        return idx_ != other.idx_;
+    }
+
+private:
+    uint32_t idx_{INVALID_INDEX};
+};
+
+/**
+ *  Dense table that maps handles to the entities. Entities are not owned, they live in the allocator.
+ */
+template<class T>
+class HandleTable final {
+public:
+    Handle<T> Register(T *entity) {
+        assert(entity != nullptr);
+        assert(entities_.size() < Handle<T>::INVALID_INDEX);
+        entities_.push_back(entity);
+        return Handle<T>{static_cast<uint32_t>(entities_.size() - 1)};
+    }
+
+    [[nodiscard]] T *Get(Handle<T> handle) const {
+        if (!handle.IsValid() || handle.GetIndex() >= entities_.size()) {
+            return nullptr;
+        }
+        return entities_[handle.GetIndex()];
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return entities_.size();
+    }
+
+    void Clear() noexcept {
+        entities_.clear();
+    }
+
+private:
+    std::vector<T *> entities_;
+};
+
+}  // namespace compiler
+
+#endif //COMPILER_HANDLE_H
@@ -1,511 +1,646 @@
-#ifndef OPTIMIZER_INSTRUCTION_H
-#define OPTIMIZER_INSTRUCTION_H
-
-#include <utility>
-#include <vector>
-#include <array>
-#include <string>
-#include <cassert>
-
-#include "common.h"
-
-namespace compiler {
-
-class BasicBlock;
-
-/**
- *  Cannot be instantiated directly, use derived classes.
- */
-class InstructionBase {
-public:
-    Graph *GetGraph();
-
-    [[nodiscard]] Opcode GetOpcode() const noexcept {
-        return op_;
-    }
-
-    void SetId(size_t id) noexcept {
-        id_ = id;
-    }
-
-    [[nodiscard]] size_t GetId() const noexcept {
-        return id_;
-    }
-
-    void SetType(InstrType type) noexcept {
-        type_ = type;
-    }
-
-    [[nodiscard]] InstrType GetType() const noexcept {
-        return type_;
-    }
-
-    void AddUsers(std::initializer_list<InstructionBase *> uses) {
-        users_.insert(users_.end(), uses.begin(), uses.end());
-    }
-
-    void AddUsers(std::vector<InstructionBase *> uses) {
-        users_.insert(users_.end(), uses.begin(), uses.end());
-    }
-
-    [[nodiscard]] std::vector<InstructionBase *> GetUsers() const noexcept {
-        return users_;
-    }
-
-    void RemoveUser(const InstructionBase *instr) {
-        auto it = std::find(users_.begin(), users_.end(), instr);
-        if (it == users_.end()) {
-            std::cerr << "Warning! Try to remove user that doesn't belong to this instruction" << std::endl;
-            return;
-        }
-        users_.erase(it);
-    }
-
-    void TryRemoveUser(const InstructionBase *instr) {
-        auto it = std::find(users_.begin(), users_.end(), instr);
-        if (it == users_.end()) {
-            return;
-        }
-        users_.erase(it);
-    }
-
-    void RemoveUsers() {
-        users_.clear();
-    }
-
-    virtual void RemoveInputs() {
-        auto inputs = GetInputs();
-        for (auto *input : inputs) {
-            if (input != nullptr) {
-                RemoveInput(input->def());
-            }
-        }
-    }
-
-    // Replace user that point to this instruction by given instruction.
-    void ReplaceUserForInputs(InstructionBase *new_user) const {
-        assert(new_user != nullptr && new_user != this);
-        for (auto *input_arg: GetInputs()) {
-            auto *input_instr = input_arg->def();
-            input_instr->RemoveUser(this);
-            input_instr->AddUsers({new_user});
-        }
-    }
-
-    // Replace inputs that point to this instruction by given instruction.
-    void ReplaceInputForUsers(InstructionBase *new_input) const {
-        assert(new_input != nullptr && new_input != this);
-        for (auto *user: users_) {
-            for (auto *input: user->GetInputs()) {
-                if (input->def() == this) {
-                    input->SetDef(new_input);
-                }
-            }
-        }
-    }
-
-    void SetPrev(InstructionBase *prev) noexcept {
-        prev_ = prev;
-    }
-
-    [[nodiscard]] InstructionBase *GetPrev() const {
-        return prev_;
-    }
-
-    void SetNext(InstructionBase *next) noexcept {
-        next_ = next;
-    }
-
-    [[nodiscard]] InstructionBase *GetNext() const noexcept {
-        return next_;
-    }
-
-    void SetBasicBlock(BasicBlock *bb) noexcept {
-        bb_ = bb;
-    }
-
-    [[nodiscard]] BasicBlock *GetBasicBlock() const noexcept {
-        return bb_;
-    }
-
-    bool IsNextTo(InstructionBase *other) const noexcept;
-
-    bool IsDominatedBy(InstructionBase *other) const noexcept;
-
-    // Remove this instruction from the block, but not with delete function, but by making it nop
-    void MakeNop() {
-        op_ = Opcode::NOP;
-        for (auto *user : users_) {
-            user->TryRemoveInput(this);
-        }
-        for (auto *input : GetInputs()) {
-            input->def()->TryRemoveUser(this);
-        }
-        RemoveUsers();
-        RemoveInputs();
-    }
-
-    [[nodiscard]] bool IsSameOpcode(InstructionBase *other) const noexcept {
-        return other != this && op_ == other->GetOpcode();
-    }
-
-    [[nodiscard]] bool IsControlFlow() const noexcept {
-        return op_ >= Opcode::JA;
-    }
-
-    [[nodiscard]] bool IsJump() const noexcept {
-        return op_ == Opcode::JMP;
-    }
-
-    [[nodiscard]] bool IsConditionalBranch() const noexcept {
-        return op_ >= Opcode::JA && op_ <= Opcode::JNE;
-    }
-
-    [[nodiscard]] bool IsBoundsCheck() const noexcept {
-        return op_ == Opcode::BOUNDS_CHECK;
-    }
-
-    [[nodiscard]] bool IsCheck() const noexcept {
-        return op_ == Opcode::NULL_CHECK || op_ == Opcode::ZERO_CHECK || IsBoundsCheck();
-    }
-
-    [[nodiscard]] bool IsReturn() const noexcept {
-        return op_ == Opcode::RET;
-    }
-
-    [[nodiscard]] bool IsCall() const {
-        return op_ == Opcode::CALL;
-    }
-
-    [[nodiscard]] bool IsConstant() const {
-        return op_ == Opcode::CONSTANT;
-    }
-
-    bool IsParameter() {
-        return op_ == Opcode::PARAMETER;
-    }
-
-    [[nodiscard]] bool IsTarget() const {
-        return is_target_;
-    }
-
-    void SetIsTarget(bool is_tgt) noexcept {
-        is_target_ = is_tgt;
-    }
-
-    [[nodiscard]] InstrArg *GetDst() const noexcept {
-        assert(dst_ != nullptr && "dst location must not be nullptr");
-        return dst_;
-    }
-
-    [[nodiscard]] virtual bool HasInputs() const = 0;
-
-    [[nodiscard]] virtual std::vector<InstrArg *> GetInputs() const = 0;
-
-    virtual void RemoveInput(InstructionBase *input) = 0;
-
-    virtual void TryRemoveInput(InstructionBase *input) = 0;
-
-    virtual ~InstructionBase() = default;
-
-protected:
-    explicit InstructionBase(Opcode op);
-
-    InstructionBase(Opcode op, InstrType type, InstrArg *dst);
-
-    InstructionBase(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg *dst);
-
-
-    Opcode op_{Opcode::NONE};
-    InstrType type_{InstrType::I32};
-
-    size_t id_{static_cast<size_t>(-1)};
-
-    InstructionBase *prev_{nullptr};
-    InstructionBase *next_{nullptr};
-
-    std::vector<InstructionBase *> users_;
-    InstrArg *dst_{nullptr};
-
-    BasicBlock *bb_{nullptr};
-
-private:
-    bool is_target_{false};  // is this instruction is target to some jump
-};
-
-class DynamicInputInstr final : public InstructionBase {
-public:
-    template<typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
-    static DynamicInputInstr *
-    Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst, Args &&... inputs) {
-        return DynamicInputInstr::Create(alloc, op, type, nullptr, nullptr,
-                                         std::forward<InstrArg>(dst), std::forward<InstrArg>(inputs)...);
-    }
-
-    template<typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
-    static DynamicInputInstr *
-    Create(Allocator *alloc, Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next,
-           InstrArg &&dst, Args &&... inputs) {
-        return alloc->New<DynamicInputInstr>(
-                DynamicInputInstr(op, type, prev, next,
-                                  alloc->New<InstrArg>(std::forward<InstrArg>(dst)),
-                                  alloc->NewPool<InstrArg>(std::forward<InstrArg>(inputs)...)));
-    }
-
-    void AddArgDefs(std::initializer_list<InstrArg *> inputs) {
-        inputs_.insert(inputs_.end(), inputs.begin(), inputs.end());
-    }
-
-    [[nodiscard]] bool HasInputs() const override {
-        return !inputs_.empty();
-    }
-
-    [[nodiscard]] std::vector<InstrArg *> GetInputs() const override {
-        return inputs_;
-    }
-
-    void RemoveInput(InstructionBase *input) override {
-        auto it = std::find_if(inputs_.begin(), inputs_.end(), [input](InstrArg *arg){
-            return arg->def() == input;
-        });
-        if (it == inputs_.end()) {
-            std::cerr << "Warning! Try to remove input that doesn't belong to this instruction" << std::endl;
-            return;
-        };
-        inputs_.erase(it);
-    }
-
-    void TryRemoveInput(InstructionBase *input) override {
-        auto it = std::find_if(inputs_.begin(), inputs_.end(), [input](InstrArg *arg){
-            return arg->def() == input;
-        });
-        if (it == inputs_.end()) {
-            return;
-        };
-        inputs_.erase(it);
-    }
-
-    void RemoveInputs() override {
-        inputs_.clear();
-    }
-
-    void SetInputs(std::vector<InstrArg *> &&inputs) {
-        inputs_ = std::move(inputs);
-    }
-
-    template<typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
-    void SetInputs(Allocator *alloc, Args &&... inputs) {
-        inputs_ = alloc->NewPool<InstrArg>(std::forward<InstrArg>(inputs)...);
-    }
-
-private:
-    DynamicInputInstr(Opcode op, InstrType type, InstrArg *dst, std::vector<InstrArg *> &&inputs)
-            : InstructionBase(op, type, dst), inputs_(std::move(inputs)) {}
-
-    DynamicInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg *dst,
-                      std::vector<InstrArg *> &&inputs)
-            : InstructionBase(op, type, prev, next, dst), inputs_(std::move(inputs)) {}
-
-    std::vector<InstrArg *> inputs_;
-};
-
-class ZeroInputInstr final : public InstructionBase {
-public:
-    static ZeroInputInstr *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst) {
-        return ZeroInputInstr::Create(alloc, op, type, nullptr, nullptr, std::forward<InstrArg>(dst));
-    }
-
-    static ZeroInputInstr *
-    Create(Allocator *alloc, Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next,
-           InstrArg &&dst) {
-        return alloc->New<ZeroInputInstr>(ZeroInputInstr(op, type, prev, next,
-                                                         alloc->New<InstrArg>(std::forward<InstrArg>(dst))));
-    }
-
-    bool HasInputs() const override {
-        return false;
-    }
-
-    [[nodiscard]] std::vector<InstrArg *> GetInputs() const override {
-        return {};
-    }
-
-    void RemoveInput([[maybe_unused]] InstructionBase *input) override {
-        std::cerr << "Warning! Try to remove input in ZeroInputInstr" << std::endl;
-    }
-
-    void TryRemoveInput([[maybe_unused]] InstructionBase *input) override {
-        std::cerr << "Warning! Try to remove input in ZeroInputInstr" << std::endl;
-    }
-
-private:
-    ZeroInputInstr(Opcode op, InstrType type, InstrArg *dst) : InstructionBase(op, type, dst) {}
-
-    ZeroInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg *dst)
-            : InstructionBase(op, type, prev, next, dst) {}
-};
-
-/**
- *  Cannot be instantiated directly, use derived classes.
- *  N - amount of inputs
- */
-template<size_t N>
-class FixedInputInstr : public InstructionBase {
-public:
-    virtual ~FixedInputInstr() = default;
-
-protected:
-    template<class Derived, typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
-    static Derived *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst, Args &&... inputs) {
-        return FixedInputInstr::Create<Derived>(alloc, op, type, nullptr, nullptr,
-                                                std::forward<InstrArg>(dst),
-                                                std::forward<InstrArg>(inputs)...);
-    }
-
-    template<class Derived, typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
-    static Derived *Create(Allocator *alloc, Opcode op, InstrType type,
-                           InstructionBase *prev, InstructionBase *next, InstrArg &&dst, Args &&... inputs) {
-        static_assert(sizeof...(Args) == N, "Number of arguments does not match array size");
-        auto instr = Derived(op, type, prev, next, alloc->New<InstrArg>(std::forward<InstrArg>(dst)));
-        instr.inputs_ = alloc->NewPoolAsArray<InstrArg>(std::forward<InstrArg>(inputs)...);
-        return alloc->New<Derived>(std::move(instr));
-    }
-
-    [[nodiscard]] bool HasInputs() const override {
-        static_assert(N > 0 && "For N = 0 use ZeroInputInstr");
-        return true;
-    }
-
-    [[nodiscard]] std::vector<InstrArg *> GetInputs() const override {
-        assert(0 && "Cannot be used for this class");
-        return {};
-    }
-
-    void RemoveInput(InstructionBase *input) override {
-        auto it = std::find_if(inputs_.begin(), inputs_.end(), [input](InstrArg *arg){
-            return arg != nullptr && arg->def() == input;
-        });
-        if (it == inputs_.end()) {
-            std::cerr << "Warning! Try to remove input that doesn't belong to this instruction" << std::endl;
-            return;
-        };
-        *it = nullptr;
-    }
-
-    void TryRemoveInput(InstructionBase *input) override {
-        auto it = std::find_if(inputs_.begin(), inputs_.end(), [input](InstrArg *arg){
-            return arg->def() == input;
-        });
-        if (it == inputs_.end()) {
-            return;
-        };
-        *it = nullptr;
-    }
-
-    void SetInputs(std::array<InstrArg *, N> &&inputs) {
-        inputs_ = std::move(inputs);
-    }
-
-protected:
-    std::array<InstrArg *, N> inputs_;
-
-protected:
-    FixedInputInstr(Opcode op, InstrType type, InstrArg *dst) : InstructionBase(op, type, dst) {}
-
-    FixedInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg *dst)
-            : InstructionBase(op, type, prev, next, dst) {}
-
-};
-
-class OneInputInstr final : public FixedInputInstr<1> {
-public:
-    static OneInputInstr *
-    Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst, InstrArg &&arg) {
-        return OneInputInstr::Create(alloc, op, type, nullptr, nullptr,
-                                     std::forward<InstrArg>(dst), std::forward<InstrArg>(arg));
-    }
-
-    static OneInputInstr *Create(Allocator *alloc, Opcode op, InstrType type,
-                                 InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
-                                 InstrArg &&arg) {
-        return FixedInputInstr::Create<OneInputInstr>(alloc, op, type, prev, next,
-                                                      std::forward<InstrArg>(dst),
-                                                      std::forward<InstrArg>(arg));
-    }
-
-    [[nodiscard]] std::vector<InstrArg *> GetInputs() const override {
-        assert(inputs_.size() == 1);
-        return {inputs_.front()};
-    }
-
-public:
-    // Not recommended, better use Create methods
-    OneInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg *dst)
-            : FixedInputInstr<1>(op, type, prev, next, dst) {}
-};
-
-class TwoInputInstr final : public FixedInputInstr<2> {
-public:
-    static TwoInputInstr *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst,
-                                 InstrArg &&arg1, InstrArg &&arg2) {
-        return TwoInputInstr::Create(alloc, op, type, nullptr, nullptr,
-                                     std::forward<InstrArg>(dst),
-                                     std::forward<InstrArg>(arg1),
-                                     std::forward<InstrArg>(arg2));
-    }
-
-    static TwoInputInstr *Create(Allocator *alloc, Opcode op, InstrType type,
-                                 InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
-                                 InstrArg &&arg1, InstrArg &&arg2) {
-        return FixedInputInstr::Create<TwoInputInstr>(alloc, op, type, prev, next,
-                                                      std::forward<InstrArg>(dst),
-                                                      std::forward<InstrArg>(arg1),
-                                                      std::forward<InstrArg>(arg2));
-    }
-
-    [[nodiscard]] std::vector<InstrArg *> GetInputs() const override {
-        assert(inputs_.size() == 2);
-        return {inputs_.at(0), inputs_.at(1)};
-    }
-
-public:
-    // Not recommended, better use Create methods
-    TwoInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg *dst)
-            : FixedInputInstr<2>(op, type, prev, next, dst) {}
-};
-
-class ThreeInputInstr final : public FixedInputInstr<3> {
-public:
-    static ThreeInputInstr *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst,
-                                   InstrArg &&arg1, InstrArg &&arg2, InstrArg &&arg3) {
-        return ThreeInputInstr::Create(alloc, op, type, nullptr, nullptr,
-                                       std::forward<InstrArg>(dst),
-                                       std::forward<InstrArg>(arg1),
-                                       std::forward<InstrArg>(arg2),
-                                       std::forward<InstrArg>(arg3));
-    }
-
-    static ThreeInputInstr *Create(Allocator *alloc, Opcode op, InstrType type,
-                                   InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
-                                   InstrArg &&arg1, InstrArg &&arg2, InstrArg &&arg3) {
-        return FixedInputInstr::Create<ThreeInputInstr>(alloc, op, type, prev, next,
-                                                        std::forward<InstrArg>(dst),
-                                                        std::forward<InstrArg>(arg1),
-                                                        std::forward<InstrArg>(arg2),
-                                                        std::forward<InstrArg>(arg3));
-    }
-
-    [[nodiscard]] std::vector<InstrArg *> GetInputs() const override {
-        assert(inputs_.size() == 3);
-        return {inputs_.at(0), inputs_.at(1), inputs_.at(2)};
-    }
-
-public:
-    // Not recommended, better use Create methods
-    ThreeInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg *dst)
-            : FixedInputInstr<3>(op, type, prev, next, dst) {}
-};
-
-}  // namespace compiler
-
-#endif //OPTIMIZER_INSTRUCTION_H
+#ifndef OPTIMIZER_INSTRUCTION_H
+#define OPTIMIZER_INSTRUCTION_H
+
+#include <utility>
+#include <vector>
+#include <array>
+#include <string>
+#include <cassert>
+#include <limits>
+
+#include "common.h"
+#include "span.h"
+
+namespace compiler {
+
+class BasicBlock;
+
+/**
+ *  Input slot of an instruction. Besides the argument itself it is a node of the intrusive doubly-linked
+ *  use-list of its def, so removing or replacing a use doesn't need any search or allocation.
+ */
+class Use final : public InstrArg {
+public:
+    Use() = default;
+
+    explicit Use(InstrArg &&arg) : InstrArg(std::move(arg)) {}
+
+    Use(const Use &) = delete;
+    Use &operator=(const Use &) = delete;
+
+    // Bind the slot to the instruction it belongs to and link it into the use-list of its def
+    void Attach(InstructionBase *user);
+
+    // Unlink the slot from the use-list of its def, def itself is kept in the arg
+    void Detach();
+
+    // Move the slot from the use-list of the current def to the use-list of the new one
+    void SetDef(InstructionBase *def);
+
+    // Def of the data flow edge, nullptr for jump targets and callee graphs
+    [[nodiscard]] InstructionBase *GetDef() const {
+        return IsDataFlow() ? def() : nullptr;
+    }
+
+    [[nodiscard]] InstructionBase *GetUser() const noexcept {
+        return user_;
+    }
+
+    [[nodiscard]] Use *GetNextUse() const noexcept {
+        return next_use_;
+    }
+
+    [[nodiscard]] bool IsAttached() const noexcept {
+        return attached_;
+    }
+
+private:
+    friend class InstructionBase;
+
+    InstructionBase *user_{nullptr};
+    Use *prev_use_{nullptr};
+    Use *next_use_{nullptr};
+    bool attached_{false};
+};
+
+struct NextUse {
+    Use *operator()(const Use *use) const {
+        return use->GetNextUse();
+    }
+};
+
+struct UseToUser {
+    InstructionBase *operator()(const Use *use) const {
+        return use->GetUser();
+    }
+};
+
+// Users in the order of linking, the same user is met as many times as it reads the def
+using UsersRange = LinkedRange<Use, InstructionBase *, NextUse, UseToUser>;
+
+/**
+ *  Cannot be instantiated directly, use derived classes.
+ */
+class InstructionBase {
+public:
+    Graph *GetGraph();
+
+    [[nodiscard]] Opcode GetOpcode() const noexcept {
+        return op_;
+    }
+
+    void SetId(size_t id) noexcept {
+        id_ = id;
+    }
+
+    [[nodiscard]] size_t GetId() const noexcept {
+        return id_;
+    }
+
+    void SetHandle(InstrHandle handle) noexcept {
+        handle_ = handle;
+    }
+
+    // Valid only after the handles are built by the graph, see Graph::BuildHandles
+    [[nodiscard]] InstrHandle GetHandle() const noexcept {
+        return handle_;
+    }
+
+    void SetType(InstrType type) noexcept {
+        type_ = type;
+    }
+
+    [[nodiscard]] InstrType GetType() const noexcept {
+        return type_;
+    }
+
+    // Inputs are linked to their defs on creation, so it is needed only for implicit data flow (e.g. accumulator)
+    void AddUser(InstructionBase *user);
+
+    void AddUsers(std::initializer_list<InstructionBase *> users) {
+        for (auto *user: users) {
+            AddUser(user);
+        }
+    }
+
+    void AddUsers(const std::vector<InstructionBase *> &users) {
+        for (auto *user: users) {
+            AddUser(user);
+        }
+    }
+
+    [[nodiscard]] UsersRange GetUsers() const {
+        return UsersRange{first_use_};
+    }
+
+    [[nodiscard]] Use *GetFirstUse() const noexcept {
+        return first_use_;
+    }
+
+    [[nodiscard]] bool HasUsers() const noexcept {
+        return first_use_ != nullptr;
+    }
+
+    void RemoveUser(const InstructionBase *instr) {
+        if (!TryRemoveUserImpl(instr)) {
+            std::cerr << "Warning! Try to remove user that doesn't belong to this instruction" << std::endl;
+        }
+    }
+
+    void TryRemoveUser(const InstructionBase *instr) {
+        TryRemoveUserImpl(instr);
+    }
+
+    void RemoveUsers() {
+        while (first_use_ != nullptr) {
+            first_use_->Detach();
+        }
+    }
+
+    // Detach and remove all the inputs, slots of fixed instructions become nullptr
+    void RemoveInputs();
+
+    // Replace user that point to this instruction by given instruction.
+    void ReplaceUserForInputs(InstructionBase *new_user) const {
+        assert(new_user != nullptr && new_user != this);
+        for (auto *input: GetInputs()) {
+            auto *input_instr = input != nullptr ? input->GetDef() : nullptr;
+            if (input_instr == nullptr) {
+                continue;
+            }
+            input->Detach();
+            input_instr->AddUser(new_user);
+        }
+    }
+
+    // Replace inputs that point to this instruction by given instruction (RAUW), O(amount of uses).
+    void ReplaceInputForUsers(InstructionBase *new_input) {
+        assert(new_input != nullptr && new_input != this);
+        Use *use = first_use_;
+        while (use != nullptr) {
+            Use *next = use->next_use_;
+            use->SetDef(new_input);
+            use = next;
+        }
+    }
+
+    void SetPrev(InstructionBase *prev) noexcept {
+        prev_ = prev;
+    }
+
+    [[nodiscard]] InstructionBase *GetPrev() const {
+        return prev_;
+    }
+
+    void SetNext(InstructionBase *next) noexcept {
+        next_ = next;
+    }
+
+    [[nodiscard]] InstructionBase *GetNext() const noexcept {
+        return next_;
+    }
+
+    void SetBasicBlock(BasicBlock *bb) noexcept {
+        bb_ = bb;
+    }
+
+    [[nodiscard]] BasicBlock *GetBasicBlock() const noexcept {
+        return bb_;
+    }
+
+    // Position in the block, the numbers grow from the first instruction to the last one but aren't contiguous
+    void SetOrder(uint32_t order) noexcept {
+        order_ = order;
+    }
+
+    [[nodiscard]] uint32_t GetOrder() const noexcept {
+        return order_;
+    }
+
+    // Is this instruction placed after other one (or is it the same instruction), constant time
+    bool IsNextTo(InstructionBase *other) const noexcept;
+
+    bool IsDominatedBy(InstructionBase *other) const noexcept;
+
+    // Remove this instruction from the data flow, but keep it in the block as nop
+    void MakeNop() {
+        op_ = Opcode::NOP;
+        DropUses();
+        RemoveInputs();
+    }
+
+    // Unlink the instruction (must be already removed from its block) from the data flow and return its
+    // memory and input args to the allocator free lists. The instruction must be created by Create method
+    static void Delete(Allocator *alloc, InstructionBase *instr);
+
+    [[nodiscard]] bool IsSameOpcode(InstructionBase *other) const noexcept {
+        return other != this && op_ == other->GetOpcode();
+    }
+
+    [[nodiscard]] bool IsControlFlow() const noexcept {
+        return op_ >= Opcode::JA;
+    }
+
+    [[nodiscard]] bool IsJump() const noexcept {
+        return op_ == Opcode::JMP;
+    }
+
+    [[nodiscard]] bool IsConditionalBranch() const noexcept {
+        return op_ >= Opcode::JA && op_ <= Opcode::JNE;
+    }
+
+    [[nodiscard]] bool IsBoundsCheck() const noexcept {
+        return op_ == Opcode::BOUNDS_CHECK;
+    }
+
+    [[nodiscard]] bool IsCheck() const noexcept {
+        return op_ == Opcode::NULL_CHECK || op_ == Opcode::ZERO_CHECK || IsBoundsCheck();
+    }
+
+    [[nodiscard]] bool IsReturn() const noexcept {
+        return op_ == Opcode::RET;
+    }
+
+    [[nodiscard]] bool IsCall() const {
+        return op_ == Opcode::CALL;
+    }
+
+    [[nodiscard]] bool IsConstant() const {
+        return op_ == Opcode::CONSTANT;
+    }
+
+    bool IsParameter() {
+        return op_ == Opcode::PARAMETER;
+    }
+
+    [[nodiscard]] bool IsTarget() const {
+        return is_target_;
+    }
+
+    void SetIsTarget(bool is_tgt) noexcept {
+        is_target_ = is_tgt;
+    }
+
+    [[nodiscard]] InstrArg *GetDst() noexcept {
+        return &dst_;
+    }
+
+    [[nodiscard]] const InstrArg *GetDst() const noexcept {
+        return &dst_;
+    }
+
+    // Operands are kept in the base, so the accessors below are not virtual and may be inlined into passes
+    [[nodiscard]] bool HasInputs() const noexcept {
+        return inputs_num_ != 0;
+    }
+
+    [[nodiscard]] size_t GetInputsNum() const noexcept {
+        return inputs_num_;
+    }
+
+    [[nodiscard]] Use *GetInput(size_t idx) const noexcept {
+        assert(idx < inputs_num_);
+        return inputs_data_[idx];
+    }
+
+    [[nodiscard]] Span<Use *> GetInputs() const noexcept {
+        return {inputs_data_, inputs_num_};
+    }
+
+    void RemoveInput(InstructionBase *input) {
+        size_t idx = FindInput(input);
+        if (idx == inputs_num_) {
+            std::cerr << "Warning! Try to remove input that doesn't belong to this instruction" << std::endl;
+            return;
+        }
+        RemoveInputAt(idx);
+    }
+
+    void TryRemoveInput(InstructionBase *input) {
+        size_t idx = FindInput(input);
+        if (idx != inputs_num_) {
+            RemoveInputAt(idx);
+        }
+    }
+
+    [[nodiscard]] bool HasDynamicInputs() const noexcept {
+        return has_dynamic_inputs_;
+    }
+
+    virtual ~InstructionBase() = default;
+
+    // Instructions are allocated in place and may keep pointers to their own args, so they are not copyable
+    InstructionBase(const InstructionBase &) = delete;
+    InstructionBase &operator=(const InstructionBase &) = delete;
+
+protected:
+    explicit InstructionBase(Opcode op);
+
+    InstructionBase(Opcode op, InstrType type, InstrArg &&dst);
+
+    InstructionBase(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst);
+
+    // Is called by derived classes every time their inputs storage is (re)allocated
+    void SetInputsStorage(Use **data, size_t num, bool is_dynamic = false) noexcept {
+        assert(num <= std::numeric_limits<uint32_t>::max());
+        inputs_data_ = data;
+        inputs_num_ = static_cast<uint32_t>(num);
+        has_dynamic_inputs_ = is_dynamic;
+    }
+
+    Opcode op_{Opcode::NONE};
+    InstrType type_{InstrType::I32};
+    InstrHandle handle_;  // fits into the padding before id_
+
+    size_t id_{static_cast<size_t>(-1)};
+
+    InstructionBase *prev_{nullptr};
+    InstructionBase *next_{nullptr};
+
+    InstrArg dst_;  // kept inline, so the instruction and its dst are a single allocation
+
+    BasicBlock *bb_{nullptr};
+
+private:
+    friend class Use;
+
+    bool TryRemoveUserImpl(const InstructionBase *instr);
+
+    [[nodiscard]] size_t FindInput(const InstructionBase *input) const noexcept {
+        for (size_t i = 0; i < inputs_num_; ++i) {
+            if (inputs_data_[i] != nullptr && inputs_data_[i]->GetDef() == input) {
+                return i;
+            }
+        }
+        return inputs_num_;
+    }
+
+    // Detach the input slot and remove it: erase for dynamic inputs, set nullptr for fixed ones
+    void RemoveInputAt(size_t idx);
+
+    // Users drop their input slots which read this instruction
+    void DropUses() {
+        while (first_use_ != nullptr) {
+            Use *use = first_use_;
+            use->user_->DropInput(use);
+        }
+    }
+
+    // Detach the given input slot and remove it from the inputs of this instruction
+    void DropInput(Use *input) {
+        for (size_t i = 0; i < inputs_num_; ++i) {
+            if (inputs_data_[i] == input) {
+                RemoveInputAt(i);
+                return;
+            }
+        }
+        assert(0 && "Use doesn't belong to this instruction");
+    }
+
+    // Inputs of the derived instruction (fixed inline array or dynamic vector)
+    Use **inputs_data_{nullptr};
+    uint32_t inputs_num_{0};
+    uint32_t order_{0};  // see BasicBlock::UpdateInstrsOrder
+    bool has_dynamic_inputs_{false};
+    bool is_target_{false};  // is this instruction is target to some jump
+
+    // Intrusive list of uses, every node is an input slot of some user
+    Use *first_use_{nullptr};
+    Use *last_use_{nullptr};
+};
+
+class DynamicInputInstr final : public InstructionBase {
+public:
+    template<typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
+    static DynamicInputInstr *
+    Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst, Args &&... inputs) {
+        return DynamicInputInstr::Create(alloc, op, type, nullptr, nullptr,
+                                         std::forward<InstrArg>(dst), std::forward<InstrArg>(inputs)...);
+    }
+
+    template<typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
+    static DynamicInputInstr *
+    Create(Allocator *alloc, Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next,
+           InstrArg &&dst, Args &&... inputs) {
+        return alloc->New<DynamicInputInstr>(op, type, prev, next, std::forward<InstrArg>(dst),
+                                             std::vector<Use *>{alloc->New<Use>(std::forward<InstrArg>(inputs))...});
+    }
+
+    void AddInput(Allocator *alloc, InstrArg &&input) {
+        Use *use = alloc->New<Use>(std::forward<InstrArg>(input));
+        use->Attach(this);
+        inputs_.push_back(use);
+        SyncInputs();
+    }
+
+    template<typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
+    void SetInputs(Allocator *alloc, Args &&... inputs) {
+        RemoveInputs();
+        inputs_ = {alloc->New<Use>(std::forward<InstrArg>(inputs))...};
+        AttachInputs();
+    }
+
+private:
+    template<class> friend class storage::Arena;
+    friend class InstructionBase;
+
+    DynamicInputInstr(Opcode op, InstrType type, InstrArg &&dst, std::vector<Use *> &&inputs)
+            : InstructionBase(op, type, std::forward<InstrArg>(dst)), inputs_(std::move(inputs)) {
+        AttachInputs();
+    }
+
+    DynamicInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                      std::vector<Use *> &&inputs)
+            : InstructionBase(op, type, prev, next, std::forward<InstrArg>(dst)), inputs_(std::move(inputs)) {
+        AttachInputs();
+    }
+
+    void AttachInputs() {
+        for (auto *input: inputs_) {
+            input->Attach(this);
+        }
+        SyncInputs();
+    }
+
+    void EraseInput(size_t idx) {
+        inputs_.erase(inputs_.begin() + static_cast<std::ptrdiff_t>(idx));
+        SyncInputs();
+    }
+
+    void ClearInputs() {
+        inputs_.clear();
+        SyncInputs();
+    }
+
+    // Vector might be reallocated, so the base has to see its actual data
+    void SyncInputs() noexcept {
+        SetInputsStorage(inputs_.data(), inputs_.size(), true);
+    }
+
+    std::vector<Use *> inputs_;
+};
+
+class ZeroInputInstr final : public InstructionBase {
+public:
+    static ZeroInputInstr *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst) {
+        return ZeroInputInstr::Create(alloc, op, type, nullptr, nullptr, std::forward<InstrArg>(dst));
+    }
+
+    static ZeroInputInstr *
+    Create(Allocator *alloc, Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next,
+           InstrArg &&dst) {
+        return alloc->New<ZeroInputInstr>(op, type, prev, next, std::forward<InstrArg>(dst));
+    }
+
+private:
+    template<class> friend class storage::Arena;
+
+    ZeroInputInstr(Opcode op, InstrType type, InstrArg &&dst) : InstructionBase(op, type, std::forward<InstrArg>(dst)) {}
+
+    ZeroInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst)
+            : InstructionBase(op, type, prev, next, std::forward<InstrArg>(dst)) {}
+};
+
+/**
+ *  Cannot be instantiated directly, use derived classes.
+ *  N - amount of inputs, input args are stored inline right after the instruction fields.
+ */
+template<size_t N>
+class FixedInputInstr : public InstructionBase {
+public:
+    static_assert(N > 0 && "For N = 0 use ZeroInputInstr");
+
+    virtual ~FixedInputInstr() = default;
+
+protected:
+    template<class Derived, typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
+    static Derived *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst, Args &&... inputs) {
+        return FixedInputInstr::Create<Derived>(alloc, op, type, nullptr, nullptr,
+                                                std::forward<InstrArg>(dst),
+                                                std::forward<InstrArg>(inputs)...);
+    }
+
+    template<class Derived, typename... Args, std::enable_if_t<(std::is_same_v<Args, InstrArg> && ...), bool> = true>
+    static Derived *Create(Allocator *alloc, Opcode op, InstrType type,
+                           InstructionBase *prev, InstructionBase *next, InstrArg &&dst, Args &&... inputs) {
+        static_assert(sizeof...(Args) == N, "Number of arguments does not match array size");
+        return alloc->New<Derived>(op, type, prev, next, std::forward<InstrArg>(dst),
+                                   std::array<InstrArg, N>{std::forward<InstrArg>(inputs)...});
+    }
+
+    FixedInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                    std::array<InstrArg, N> &&args)
+            : InstructionBase(op, type, prev, next, std::forward<InstrArg>(dst)) {
+        for (size_t i = 0; i < N; ++i) {
+            static_cast<InstrArg &>(args_[i]) = std::move(args[i]);
+            args_[i].Attach(this);
+            inputs_[i] = &args_[i];
+        }
+        SetInputsStorage(inputs_.data(), N);
+    }
+
+    FixedInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst)
+            : FixedInputInstr(op, type, prev, next, std::forward<InstrArg>(dst), std::array<InstrArg, N>{}) {}
+
+    std::array<Use *, N> inputs_;  // point to args_, removed input is nullptr
+    std::array<Use, N> args_;
+};
+
+class OneInputInstr final : public FixedInputInstr<1> {
+public:
+    static OneInputInstr *
+    Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst, InstrArg &&arg) {
+        return OneInputInstr::Create(alloc, op, type, nullptr, nullptr,
+                                     std::forward<InstrArg>(dst), std::forward<InstrArg>(arg));
+    }
+
+    static OneInputInstr *Create(Allocator *alloc, Opcode op, InstrType type,
+                                 InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                                 InstrArg &&arg) {
+        return FixedInputInstr::Create<OneInputInstr>(alloc, op, type, prev, next,
+                                                      std::forward<InstrArg>(dst),
+                                                      std::forward<InstrArg>(arg));
+    }
+
+public:
+    // Not recommended, better use Create methods
+    OneInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst)
+            : FixedInputInstr<1>(op, type, prev, next, std::forward<InstrArg>(dst)) {}
+
+private:
+    template<class> friend class storage::Arena;
+
+    OneInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                  std::array<InstrArg, 1> &&args)
+            : FixedInputInstr<1>(op, type, prev, next, std::forward<InstrArg>(dst), std::move(args)) {}
+};
+
+class TwoInputInstr final : public FixedInputInstr<2> {
+public:
+    static TwoInputInstr *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst,
+                                 InstrArg &&arg1, InstrArg &&arg2) {
+        return TwoInputInstr::Create(alloc, op, type, nullptr, nullptr,
+                                     std::forward<InstrArg>(dst),
+                                     std::forward<InstrArg>(arg1),
+                                     std::forward<InstrArg>(arg2));
+    }
+
+    static TwoInputInstr *Create(Allocator *alloc, Opcode op, InstrType type,
+                                 InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                                 InstrArg &&arg1, InstrArg &&arg2) {
+        return FixedInputInstr::Create<TwoInputInstr>(alloc, op, type, prev, next,
+                                                      std::forward<InstrArg>(dst),
+                                                      std::forward<InstrArg>(arg1),
+                                                      std::forward<InstrArg>(arg2));
+    }
+
+public:
+    // Not recommended, better use Create methods
+    TwoInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst)
+            : FixedInputInstr<2>(op, type, prev, next, std::forward<InstrArg>(dst)) {}
+
+private:
+    template<class> friend class storage::Arena;
+
+    TwoInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                  std::array<InstrArg, 2> &&args)
+            : FixedInputInstr<2>(op, type, prev, next, std::forward<InstrArg>(dst), std::move(args)) {}
+};
+
+class ThreeInputInstr final : public FixedInputInstr<3> {
+public:
+    static ThreeInputInstr *Create(Allocator *alloc, Opcode op, InstrType type, InstrArg &&dst,
+                                   InstrArg &&arg1, InstrArg &&arg2, InstrArg &&arg3) {
+        return ThreeInputInstr::Create(alloc, op, type, nullptr, nullptr,
+                                       std::forward<InstrArg>(dst),
+                                       std::forward<InstrArg>(arg1),
+                                       std::forward<InstrArg>(arg2),
+                                       std::forward<InstrArg>(arg3));
+    }
+
+    static ThreeInputInstr *Create(Allocator *alloc, Opcode op, InstrType type,
+                                   InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                                   InstrArg &&arg1, InstrArg &&arg2, InstrArg &&arg3) {
+        return FixedInputInstr::Create<ThreeInputInstr>(alloc, op, type, prev, next,
+                                                        std::forward<InstrArg>(dst),
+                                                        std::forward<InstrArg>(arg1),
+                                                        std::forward<InstrArg>(arg2),
+                                                        std::forward<InstrArg>(arg3));
+    }
+
+public:
+    // Not recommended, better use Create methods
+    ThreeInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst)
+            : FixedInputInstr<3>(op, type, prev, next, std::forward<InstrArg>(dst)) {}
+
+private:
+    template<class> friend class storage::Arena;
+
+    ThreeInputInstr(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next, InstrArg &&dst,
+                    std::array<InstrArg, 3> &&args)
+            : FixedInputInstr<3>(op, type, prev, next, std::forward<InstrArg>(dst), std::move(args)) {}
+};
+
+}  // namespace compiler
+
+#endif //OPTIMIZER_INSTRUCTION_H
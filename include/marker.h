@@ -1,55 +1,94 @@
 #ifndef COMPILER_MARKER_H
 #define COMPILER_MARKER_H
 
-#include <iomanip>
+#include <array>
+#include <cstdint>
+#include <cassert>
 
+namespace compiler {
+
+class Graph;
+
+// Amount of markers which can be used at the same time in one graph
+constexpr const uint32_t MAX_MARKERS_NUM = 4;
+constexpr const uint32_t MARKER_SLOT_BITS = 2;
+static_assert((1U << MARKER_SLOT_BITS) == MAX_MARKERS_NUM);
+
+/**
+ *  Visited-set handed out by the graph, see Graph::NewMarker. The value is a unique epoch together with
+ *  the slot which the marker occupies in every entity, so an entity is marked if its slot keeps exactly
+ *  this value. Stamps of the previous markers never match the new one, so nothing is cleared between walks.
+ */
 class Marker final {
 public:
-    enum class Color : uint8_t {
-        WHITE = 0b00,
-        GREY = 0b01,
-        BLACK = 0b10
-    };
-
     Marker() = default;
 
-    // Set color
-    Marker &operator|=(const Color &c) {
-        color_ |= static_cast<uint8_t>(c);
-        return *this;
-    }
-
-    // Unset color
-    Marker &operator&=(const Color &c) {
-        // reversed color bits
-        switch (c) {
-            case Color::GREY:
-                color_ &= 0b10;
-                break;
-            case Color::BLACK:
-                color_ &= 0b01;
-                break;
-            default:
-                color_ &= 0b11;
-                break;
-        }
-        return *this;
+    Marker(uint32_t epoch, uint32_t slot) : value_((epoch << MARKER_SLOT_BITS) | slot) {
+        assert(slot < MAX_MARKERS_NUM);
+    }
+
+    [[nodiscard]] uint32_t GetSlot() const noexcept {
+        return value_ & (MAX_MARKERS_NUM - 1);
+    }
+
+    [[nodiscard]] uint32_t GetValue() const noexcept {
+        return value_;
+    }
+
+    [[nodiscard]] bool IsValid() const noexcept {
+        return value_ != 0;
+    }
+
+private:
+    uint32_t value_{0};
+};
+
+/**
+ *  Marker stamps kept by an entity, one per slot.
+ */
+class MarkerStamps final {
+public:
+    void Set(Marker marker) {
+        assert(marker.IsValid());
+        stamps_[marker.GetSlot()] = marker.GetValue();
     }
 
-    [[nodiscard]] bool IsWhite() const {
-        return (color_ == static_cast<uint8_t>(Color::WHITE));
+    void Reset(Marker marker) {
+        if (IsSet(marker)) {
+            stamps_[marker.GetSlot()] = 0;
+        }
     }
 
-    [[nodiscard]] bool HasBlack() const {
-        return ((color_ & 0b10) == static_cast<uint8_t>(Color::BLACK));
+    [[nodiscard]] bool IsSet(Marker marker) const {
+        assert(marker.IsValid());
+        return stamps_[marker.GetSlot()] == marker.GetValue();
     }
 
-    [[nodiscard]] bool HasGrey() const {
-        return ((color_ & 0b01) == static_cast<uint8_t>(Color::GREY));
+private:
+    std::array<uint32_t, MAX_MARKERS_NUM> stamps_{};
+};
+
+/**
+ *  Takes a new marker from the graph and gives its slot back when destroyed.
+ */
+class MarkerHolder final {
+public:
+    explicit MarkerHolder(Graph *graph);
+
+    MarkerHolder(const MarkerHolder &) = delete;
+    MarkerHolder &operator=(const MarkerHolder &) = delete;
+
+    ~MarkerHolder();
+
+    [[nodiscard]] Marker Get() const noexcept {
+        return marker_;
     }
 
 private:
-    uint8_t color_ = static_cast<uint8_t>(Color::WHITE);
+    Graph *graph_;
+    Marker marker_;
 };
 
+}  // namespace compiler
+
 #endif //COMPILER_MARKER_H
@@ -0,0 +1,179 @@
+#ifndef COMPILER_SPAN_H
+#define COMPILER_SPAN_H
+
+#include <vector>
+#include <array>
+#include <iterator>
+#include <stdexcept>
+#include <cassert>
+
+namespace compiler {
+
+/**
+ *  Non-owning read-only view of contiguous elements (the storage must outlive the span).
+ *  Used by the IR accessors instead of returning std::vector by value.
+ */
+template<class T>
+class Span final {
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using const_iterator = const T *;
+    using iterator = const_iterator;
+
+    Span() = default;
+
+    Span(const T *data, size_t size) : data_(data), size_(size) {}
+
+    Span(const std::vector<T> &vec) : data_(vec.data()), size_(vec.size()) {}  // NOLINT(google-explicit-constructor)
+
+    template<size_t N>
+    Span(const std::array<T, N> &arr) : data_(arr.data()), size_(N) {}  // NOLINT(google-explicit-constructor)
+
+    [[nodiscard]] iterator begin() const noexcept {
+        return data_;
+    }
+
+    [[nodiscard]] iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] const T &operator[](size_t idx) const {
+        assert(idx < size_);
+        return data_[idx];
+    }
+
+    [[nodiscard]] const T &at(size_t idx) const {
+        if (idx >= size_) {
+            throw std::out_of_range("Span index is out of range");
+        }
+        return data_[idx];
+    }
+
+    [[nodiscard]] const T &front() const {
+        assert(!empty());
+        return data_[0];
+    }
+
+    [[nodiscard]] const T &back() const {
+        assert(!empty());
+        return data_[size_ - 1];
+    }
+
+    // View of the elements starting from offset
+    [[nodiscard]] Span subspan(size_t offset) const {
+        assert(offset <= size_);
+        return {data_ + offset, size_ - offset};
+    }
+
+    [[nodiscard]] std::vector<T> ToVector() const {
+        return {begin(), end()};
+    }
+
+private:
+    const T *data_{nullptr};
+    size_t size_{0};
+};
+
+/**
+ *  Range over an intrusive singly linked sequence, Next is the functor which returns the following node.
+ *  The following node is read before the current one is handed out, so the current node may be
+ *  unlinked (removed, moved to another list) while iterating.
+ */
+template<class Node, class Value, class Next, class Deref>
+class LinkedRange final {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Value *;
+        using reference = Value;
+
+        Iterator() = default;
+
+        explicit Iterator(Node *node) : node_(node), next_(node != nullptr ? Next{}(node) : nullptr) {}
+
+        Value operator*() const {
+            return Deref{}(node_);
+        }
+
+        Iterator &operator++() {
+            node_ = next_;
+            next_ = node_ != nullptr ? Next{}(node_) : nullptr;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return node_ == other.node_;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return node_ != other.node_;
+        }
+
+    private:
+        Node *node_{nullptr};
+        Node *next_{nullptr};
+    };
+
+    explicit LinkedRange(Node *first) : first_(first) {}
+
+    [[nodiscard]] Iterator begin() const {
+        return Iterator{first_};
+    }
+
+    [[nodiscard]] Iterator end() const {
+        return Iterator{};
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return first_ == nullptr;
+    }
+
+    [[nodiscard]] Value front() const {
+        assert(!empty());
+        return Deref{}(first_);
+    }
+
+    // Linear time, the sequence doesn't keep its size
+    [[nodiscard]] size_t size() const {
+        return static_cast<size_t>(std::distance(begin(), end()));
+    }
+
+    // Linear time, the sequence doesn't keep its size
+    [[nodiscard]] Value at(size_t idx) const {
+        for (auto *node = first_; node != nullptr; node = Next{}(node)) {
+            if (idx-- == 0) {
+                return Deref{}(node);
+            }
+        }
+        throw std::out_of_range("LinkedRange index is out of range");
+    }
+
+    [[nodiscard]] std::vector<Value> ToVector() const {
+        return {begin(), end()};
+    }
+
+private:
+    Node *first_{nullptr};
+};
+
+}  // namespace compiler
+
+#endif //COMPILER_SPAN_H
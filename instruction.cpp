@@ -9,29 +9,168 @@ Graph *InstructionBase::GetGraph() {
     return bb_->GetGraph();
 }
 
-InstructionBase::InstructionBase(Opcode op) : op_(op), id_(Graph::GenInstrId()) {}
+InstructionBase::InstructionBase(Opcode op) : op_(op), id_(Graph::GenDetachedInstrId()) {}
 
-InstructionBase::InstructionBase(Opcode op, InstrType type, InstrArg *dst) : op_(op), type_(type),
-                                                                             id_(Graph::GenInstrId()),
-                                                                             dst_(dst) {}
+InstructionBase::InstructionBase(Opcode op, InstrType type, InstrArg &&dst) : op_(op), type_(type),
+                                                                              id_(Graph::GenDetachedInstrId()),
+                                                                              dst_(std::move(dst)) {}
 
 InstructionBase::InstructionBase(Opcode op, InstrType type, InstructionBase *prev, InstructionBase *next,
-                                 InstrArg *dst) : op_(op), type_(type), id_(Graph::GenInstrId()), prev_(prev),
-                                                  next_(next), dst_(dst) {}
+                                 InstrArg &&dst) : op_(op), type_(type), id_(Graph::GenDetachedInstrId()), prev_(prev),
+                                                   next_(next), dst_(std::move(dst)) {}
+
+void Use::Attach(InstructionBase *user) {
+    assert(user != nullptr);
+    if (attached_) {
+        if (user_ == user) {
+            return;
+        }
+        Detach();
+    }
+    user_ = user;
+    auto *def = GetDef();
+    if (def == nullptr) {
+        return;
+    }
+    prev_use_ = def->last_use_;
+    next_use_ = nullptr;
+    if (prev_use_ != nullptr) {
+        prev_use_->next_use_ = this;
+    } else {
+        def->first_use_ = this;
+    }
+    def->last_use_ = this;
+    attached_ = true;
+}
+
+void Use::Detach() {
+    if (!attached_) {
+        return;
+    }
+    auto *def = GetDef();
+    assert(def != nullptr);
+    if (prev_use_ != nullptr) {
+        prev_use_->next_use_ = next_use_;
+    } else {
+        def->first_use_ = next_use_;
+    }
+    if (next_use_ != nullptr) {
+        next_use_->prev_use_ = prev_use_;
+    } else {
+        def->last_use_ = prev_use_;
+    }
+    prev_use_ = nullptr;
+    next_use_ = nullptr;
+    attached_ = false;
+}
+
+void Use::SetDef(InstructionBase *def) {
+    Detach();
+    InstrArg::SetDef(def);
+    if (user_ != nullptr) {
+        Attach(user_);
+    }
+}
+
+void InstructionBase::AddUser(InstructionBase *user) {
+    assert(user != nullptr);
+    Use *free_slot = nullptr;
+    for (auto *input: user->GetInputs()) {
+        if (input == nullptr || !input->IsDataFlow()) {
+            continue;
+        }
+        if (input->def() == this) {
+            input->Attach(user);  // already linked or was removed from users before
+            return;
+        }
+        // Prefer the slot which reads the register written by this instruction
+        bool same_reg = input->type() == dst_.type() && input->num() == dst_.num();
+        if (input->def() == nullptr && (free_slot == nullptr || same_reg)) {
+            free_slot = input;
+        }
+    }
+    if (free_slot == nullptr) {
+        std::cerr << "Warning! User doesn't have a free input for this instruction" << std::endl;
+        return;
+    }
+    free_slot->SetDef(this);
+}
+
+bool InstructionBase::TryRemoveUserImpl(const InstructionBase *instr) {
+    bool found = false;
+    for (auto *input: instr->GetInputs()) {
+        if (input != nullptr && input->IsAttached() && input->GetDef() == this) {
+            input->Detach();
+            found = true;
+        }
+    }
+    return found;
+}
+
+void InstructionBase::RemoveInputAt(size_t idx) {
+    assert(idx < inputs_num_);
+    if (inputs_data_[idx] != nullptr) {
+        inputs_data_[idx]->Detach();
+    }
+    if (has_dynamic_inputs_) {
+        static_cast<DynamicInputInstr *>(this)->EraseInput(idx);
+    } else {
+        inputs_data_[idx] = nullptr;
+    }
+}
+
+void InstructionBase::RemoveInputs() {
+    for (size_t i = 0; i < inputs_num_; ++i) {
+        if (inputs_data_[i] != nullptr) {
+            inputs_data_[i]->Detach();
+            inputs_data_[i] = nullptr;
+        }
+    }
+    if (has_dynamic_inputs_) {
+        static_cast<DynamicInputInstr *>(this)->ClearInputs();
+    }
+}
+
+void InstructionBase::Delete(Allocator *alloc, InstructionBase *instr) {
+    assert(alloc != nullptr && instr != nullptr);
+    assert(instr->prev_ == nullptr && instr->next_ == nullptr && "Instruction must be removed from the block");
+    instr->DropUses();
+    if (instr->has_dynamic_inputs_) {
+        auto *dyn_instr = static_cast<DynamicInputInstr *>(instr);
+        for (auto *input: dyn_instr->inputs_) {
+            input->Detach();
+            alloc->Delete(input);
+        }
+        dyn_instr->ClearInputs();
+        alloc->Delete(dyn_instr);
+        return;
+    }
+    instr->RemoveInputs();  // fixed args are inline, so they are recycled together with the instruction
+    switch (instr->inputs_num_) {
+        case 0:
+            alloc->Delete(static_cast<ZeroInputInstr *>(instr));
+            break;
+        case 1:
+            alloc->Delete(static_cast<OneInputInstr *>(instr));
+            break;
+        case 2:
+            alloc->Delete(static_cast<TwoInputInstr *>(instr));
+            break;
+        case 3:
+            alloc->Delete(static_cast<ThreeInputInstr *>(instr));
+            break;
+        default:
+            assert(0 && "Unknown fixed inputs instruction");
+    }
+}
 
 bool InstructionBase::IsNextTo(InstructionBase *other) const noexcept {
     assert(other != nullptr && bb_ == other->GetBasicBlock());
     if (this == other) {
         return true;
     }
-    auto prev = GetPrev();
-    while (prev != nullptr) {
-        if (prev == other) {
-            return true;
-        }
-        prev = prev->GetPrev();
-    }
-    return false;
+    bb_->UpdateInstrsOrder();
+    return other->GetOrder() < order_;
 }
 
 bool InstructionBase::IsDominatedBy(InstructionBase *other) const noexcept {
@@ -0,0 +1,63 @@
+#include "include/analysis_manager.h"
+
+namespace compiler::passes {
+
+const BlocksVector &AnalysisManager::GetRpo() {
+    if (!graph_->IsRpoValid()) {
+        CountComputation(Analysis::RPO);
+    }
+    return Traversal{graph_}.getRPO();
+}
+
+bool AnalysisManager::RequireDomTree() {
+    if (graph_->IsDomTreeValid()) {
+        return true;
+    }
+    CountComputation(Analysis::DOM_TREE);
+    return DomTree{graph_, false}.Run();
+}
+
+Loop *AnalysisManager::GetRootLoop() {
+    if (!graph_->IsLoopAnalysisValid()) {
+        CountComputation(Analysis::LOOP_INFO);
+        if (!LoopAnalyzer{graph_}.Run()) {
+            return nullptr;
+        }
+    }
+    return graph_->GetRootLoop();
+}
+
+const PostDomTree *AnalysisManager::GetPostDomTree() {
+    if (!graph_->IsAnalysisValid(Analysis::POST_DOM_TREE) || !post_dom_tree_.has_value()) {
+        CountComputation(Analysis::POST_DOM_TREE);
+        if (!post_dom_tree_.emplace(graph_).Run()) {
+            post_dom_tree_.reset();
+            return nullptr;
+        }
+        graph_->MakeAnalysisValid(Analysis::POST_DOM_TREE);
+    }
+    return &post_dom_tree_.value();
+}
+
+const DominanceFrontier *AnalysisManager::GetDominanceFrontier() {
+    if (!graph_->IsAnalysisValid(Analysis::DOM_FRONTIER) || !dom_frontier_.has_value()) {
+        if (!RequireDomTree()) {
+            return nullptr;
+        }
+        CountComputation(Analysis::DOM_FRONTIER);
+        if (!dom_frontier_.emplace(graph_).Run()) {
+            dom_frontier_.reset();
+            return nullptr;
+        }
+        graph_->MakeAnalysisValid(Analysis::DOM_FRONTIER);
+    }
+    return &dom_frontier_.value();
+}
+
+bool AnalysisManager::RunPass(Pass *pass) {
+    bool res = pass->Run();
+    graph_->InvalidateAnalyses(pass->GetPreservedAnalyses());
+    return res;
+}
+
+}  // namespace compiler::passes
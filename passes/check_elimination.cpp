@@ -1,4 +1,5 @@
 #include "check_elimination.h"
+#include "analysis_manager.h"
 
 namespace compiler::passes {
 
@@ -7,17 +8,23 @@ bool CheckElimination::Run() {
         std::cerr << "Error! Graph is nullptr." << std::endl;
         return false;
     }
-    passes::Traversal tr{graph_};
-    BlocksVector rpo = tr.getRPO(true);
-    passes::DomTree domTree{graph_, true};
-    for (auto *bb: rpo) {
-        for (auto *instr: bb->GetAllInstrs()) {
+    auto &analyses = graph_->GetAnalyses();
+    if (!analyses.RequireDomTree()) {
+        std::cerr << "Error! Dominator tree building is corrupted\n";
+        return false;
+    }
+    for (auto *bb: analyses.GetRpo()) {
+        for (auto *instr: bb->GetInstrs()) {
             if (!instr->IsCheck()) {
                 continue;
             }
             RemoveDominatedChecks(instr);
         }
     }
+    for (auto *check: dead_checks_) {
+        check->GetBasicBlock()->EraseInstr(check);
+    }
+    dead_checks_.clear();
     return true;
 }
 
@@ -26,30 +33,37 @@ void CheckElimination::RemoveDominatedChecks(InstructionBase *check) {
         RemoveDominatedBoundsCheck(check);
         return;
     }
-    assert(check->GetInputs().size() == 1);
-    auto *input = check->GetInputs().front()->def();
+    assert(check->GetInputsNum() == 1);
+    auto *input = check->GetInput(0)->def();
     for (auto *i_user: input->GetUsers()) {
         if (i_user->IsSameOpcode(check) && i_user->IsDominatedBy(check)) {
             input->RemoveUser(i_user);
             i_user->ReplaceInputForUsers(check);
-            i_user->MakeNop();
+            EliminateCheck(i_user);
         }
     }
 }
 
 void CheckElimination::RemoveDominatedBoundsCheck(InstructionBase *check) {
-    assert(check->GetInputs().size() == 2);
-    auto *len_array = check->GetInputs().at(0)->def();
-    auto *idx = check->GetInputs().at(1)->def();
+    assert(check->GetInputsNum() == 2);
+    auto *len_array = check->GetInput(0)->def();
+    auto *idx = check->GetInput(1)->def();
     for (auto *i_user: len_array->GetUsers()) {
         bool is_similar_bounds_check =
-                i_user->GetInputs().at(0)->def() == len_array && i_user->GetInputs().at(1)->def() == idx;
+                i_user->GetInputsNum() == 2 && i_user->GetInput(0) != nullptr && i_user->GetInput(1) != nullptr &&
+                i_user->GetInput(0)->def() == len_array && i_user->GetInput(1)->def() == idx;
         if (i_user->IsSameOpcode(check) && is_similar_bounds_check && i_user->IsDominatedBy(check)) {
             len_array->RemoveUser(i_user);
             i_user->ReplaceInputForUsers(check);
-            i_user->MakeNop();
+            EliminateCheck(i_user);
         }
     }
 }
 
+// Check stays in the block as nop until the walk is finished, so the walk doesn't step on erased instructions
+void CheckElimination::EliminateCheck(InstructionBase *check) {
+    check->MakeNop();
+    dead_checks_.push_back(check);
+}
+
 }
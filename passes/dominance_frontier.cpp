@@ -0,0 +1,76 @@
+#include "include/dominance_frontier.h"
+
+namespace compiler::passes {
+
+/**
+ *  Cooper, Harvey, Kennedy: a join block is in the frontier of every block on the dominator tree path from its
+ *  predecessor up to its immediate dominator (exclusive). The root has the implicit entry edge, so it is a join
+ *  block if it has any predecessor and nothing dominates it strictly.
+ */
+bool DominanceFrontier::Run() {
+    if (!graph_->IsDomTreeValid()) {
+        passes::DomTree domTree{graph_, false};
+        if (!domTree.Run()) {
+            std::cerr << "Error! Dominator tree building is corrupted\n";
+            return false;
+        }
+    }
+    const BlocksVector &rpo = Traversal{graph_}.getRPO();
+    size_t ids_num = graph_->GetBlockIdsNum();
+    std::vector<bool> is_reachable(ids_num);
+    for (auto *bb: rpo) {
+        is_reachable[bb->GetId()] = true;
+    }
+    auto *root = graph_->GetRoot();
+    auto get_imm_dom = [root](BasicBlock *bb) {
+        return bb == root ? nullptr : bb->GetImmDom();
+    };
+
+    // (id of the block, block of its frontier), the last added block filters the repeated ones
+    std::vector<std::pair<size_t, BasicBlock *>> entries;
+    BlocksVector last_added(ids_num, nullptr);
+    for (auto *bb: rpo) {
+        size_t preds_num = bb->GetPreds().size() + (bb == root ? 1 : 0);
+        if (preds_num < 2) {
+            continue;
+        }
+        auto *imm_dom = get_imm_dom(bb);
+        for (auto *pred: bb->GetPreds()) {
+            if (!pred->HasId() || pred->GetId() >= ids_num || !is_reachable[pred->GetId()]) {
+                continue;
+            }
+            for (auto *runner = pred; runner != imm_dom; runner = get_imm_dom(runner)) {
+                size_t id = runner->GetId();
+                if (last_added[id] != bb) {
+                    last_added[id] = bb;
+                    entries.emplace_back(id, bb);
+                }
+            }
+        }
+    }
+
+    // Counting sort by the block id keeps the RPO of the frontier blocks
+    offsets_.assign(ids_num + 1, 0);
+    for (const auto &entry: entries) {
+        ++offsets_[entry.first + 1];
+    }
+    for (size_t i = 1; i <= ids_num; ++i) {
+        offsets_[i] += offsets_[i - 1];
+    }
+    frontiers_.resize(entries.size());
+    std::vector<size_t> fill_pos(offsets_.begin(), offsets_.end() - 1);
+    for (const auto &[id, bb]: entries) {
+        frontiers_[fill_pos[id]++] = bb;
+    }
+    return true;
+}
+
+Span<BasicBlock *> DominanceFrontier::GetFrontier(BasicBlock *bb) const {
+    if (!bb->HasId() || bb->GetId() + 1 >= offsets_.size()) {
+        return {};
+    }
+    size_t id = bb->GetId();
+    return {frontiers_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]};
+}
+
+}  // namespace compiler::passes
@@ -0,0 +1,57 @@
+#ifndef COMPILER_ANALYSIS_MANAGER_H
+#define COMPILER_ANALYSIS_MANAGER_H
+
+#include <array>
+#include <optional>
+
+#include "pass.h"
+#include "loop_analyzer.h"
+#include "post_dom_tree.h"
+#include "dominance_frontier.h"
+
+namespace compiler::passes {
+
+/**
+ *  Cache of the analyses of one graph, see Graph::GetAnalyses. Every analysis is computed on the first request
+ *  and reused until the graph invalidates it: CFG edits drop the walks of the CFG, and after a pass run by
+ *  RunPass only the analyses which the pass preserves stay valid. Dominator tree and loops are kept in the
+ *  blocks, the other results are owned by the manager.
+ */
+class AnalysisManager final {
+public:
+    explicit AnalysisManager(Graph *graph) : graph_(graph) {}
+
+    const BlocksVector &GetRpo();
+
+    // Immediate dominators and dominance queries are in the blocks, false if the tree can't be built
+    bool RequireDomTree();
+
+    // nullptr if the analysis fails
+    Loop *GetRootLoop();
+
+    const PostDomTree *GetPostDomTree();
+
+    const DominanceFrontier *GetDominanceFrontier();
+
+    // Runs the pass and invalidates the analyses it doesn't preserve
+    bool RunPass(Pass *pass);
+
+    // How many times the analysis was computed by this manager
+    [[nodiscard]] size_t GetComputationsNum(Analysis analysis) const {
+        return computations_num_[static_cast<size_t>(analysis)];
+    }
+
+private:
+    void CountComputation(Analysis analysis) {
+        ++computations_num_[static_cast<size_t>(analysis)];
+    }
+
+    Graph *graph_;
+    std::optional<PostDomTree> post_dom_tree_;
+    std::optional<DominanceFrontier> dom_frontier_;
+    std::array<size_t, ANALYSES_NUM> computations_num_{};
+};
+
+}  // namespace compiler::passes
+
+#endif //COMPILER_ANALYSIS_MANAGER_H
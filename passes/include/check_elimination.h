@@ -8,11 +8,20 @@ public:
 
     bool Run() override;
 
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::All();
+    }
+
     ~CheckElimination() override = default;
 
 private:
     void RemoveDominatedChecks(InstructionBase *check);
     void RemoveDominatedBoundsCheck(InstructionBase *check);
+
+    void EliminateCheck(InstructionBase *check);
+
+private:
+    InsnsVec dead_checks_;  // nop'ed during the walk and erased after it
 };
 
 }
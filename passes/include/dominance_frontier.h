@@ -0,0 +1,35 @@
+#ifndef COMPILER_DOMINANCE_FRONTIER_H
+#define COMPILER_DOMINANCE_FRONTIER_H
+
+#include "pass.h"
+
+namespace compiler::passes {
+
+/**
+ *  Dominance frontiers of the reachable blocks, the dominator tree of the graph is built if it is invalid.
+ *  Frontiers of all the blocks are kept in one array and the frontier of a block is the range given by
+ *  the offsets indexed by its id. Results are valid until the CFG is changed.
+ */
+class DominanceFrontier final : public Pass {
+public:
+    explicit DominanceFrontier(Graph *graph) : Pass(graph) {}
+
+    bool Run() override;
+
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::All();
+    }
+
+    ~DominanceFrontier() override = default;
+
+    // Blocks of the frontier in RPO, empty for the blocks which are unreachable or added after the analysis
+    [[nodiscard]] Span<BasicBlock *> GetFrontier(BasicBlock *bb) const;
+
+private:
+    std::vector<size_t> offsets_;  // frontier of the block with id i is [offsets_[i], offsets_[i + 1])
+    BlocksVector frontiers_;
+};
+
+}  // namespace compiler::passes
+
+#endif //COMPILER_DOMINANCE_FRONTIER_H
@@ -8,6 +8,11 @@ public:
 
     bool Run() override;
 
+    // The tree is updated for the inlined blocks if it was valid
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::None().Preserve(Analysis::DOM_TREE);
+    }
+
     ~Inlining() override = default;
 
 private:
@@ -24,6 +29,10 @@ private:
 
     BlocksVector bbs_in_rpo_;
 
+    // CFG edits of all the inlined call sites, the dominator tree is updated once for them
+    std::vector<CfgUpdate> cfg_updates_;
+    BlocksVector new_blocks_;
+
     size_t insns_limit_{50};  // heuristic for amount of instructions inside the inlining graph
 
     Allocator *alloc_{nullptr};
@@ -5,6 +5,7 @@
 #include <cassert>
 
 #include "basic_block.h"
+#include "graph.h"
 
 namespace compiler {
 
@@ -35,19 +36,49 @@ public:
         back_edges_.push_back(edge_bb);
     }
 
-    [[nodiscard]] BlocksVector GetBackEdges() const {
+    [[nodiscard]] Span<BasicBlock *> GetBackEdges() const {
         return back_edges_;
     }
 
+    // The edge to the header starts in new_bb now, back edges which are redirected to one block are merged
+    void ReplaceBackEdge(BasicBlock *old_bb, BasicBlock *new_bb) {
+        auto it = std::find(back_edges_.begin(), back_edges_.end(), old_bb);
+        if (it == back_edges_.end()) {
+            return;
+        }
+        if (std::find(back_edges_.begin(), back_edges_.end(), new_bb) != back_edges_.end()) {
+            back_edges_.erase(it);
+        } else {
+            *it = new_bb;
+        }
+    }
+
     void AddLoopBlock(BasicBlock *block) {
-        assert(std::find_if(blocks_.begin(), blocks_.end(),
-                            [block](BasicBlock *bb) { return block->GetId() == bb->GetId(); }) ==
-               blocks_.end());
+        assert(!HasBlock(block));
         block->SetLoop(this);
         blocks_.push_back(block);
     }
 
-    [[nodiscard]] BlocksVector GetLoopBlocks() const {
+    /**
+     *  The block belongs to the loop itself, not to one of the inner loops. Every block keeps its innermost loop,
+     *  so the check is constant and no per loop set of block ids is needed, those sets would take
+     *  O(loops * blocks) memory on deeply nested graphs.
+     */
+    [[nodiscard]] bool HasBlock(BasicBlock *block) const {
+        return block->GetLoop() == this;
+    }
+
+    // The block belongs to the loop or to any loop nested into it
+    [[nodiscard]] bool Contains(BasicBlock *block) const {
+        for (auto *loop = block->GetLoop(); loop != nullptr && loop->GetDepth() >= depth_; loop = loop->GetOutLoop()) {
+            if (loop == this) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] Span<BasicBlock *> GetLoopBlocks() const {
         return blocks_;
     }
 
@@ -59,14 +90,13 @@ public:
         return out_loop_;
     }
 
-    void AddInLoop(Loop *out_loop) {
-        assert(std::find_if(in_loops_.begin(), in_loops_.end(),
-                            [out_loop](Loop *loop) { return out_loop->GetId() == loop->GetId(); }) ==
-               in_loops_.end());
-        in_loops_.push_back(out_loop);
+    // The inner loop is linked once, right after its out loop is set
+    void AddInLoop(Loop *in_loop) {
+        assert(in_loop->GetOutLoop() == this);
+        in_loops_.push_back(in_loop);
     }
 
-    [[nodiscard]] std::vector<Loop *> GetInLoops() const {
+    [[nodiscard]] Span<Loop *> GetInLoops() const {
         return in_loops_;
     }
 
@@ -86,6 +116,76 @@ public:
         return is_irreducible_;
     }
 
+    void SetDepth(uint32_t depth) {
+        depth_ = depth;
+    }
+
+    // The root loop has depth 0, every nesting level adds 1
+    [[nodiscard]] uint32_t GetDepth() const {
+        return depth_;
+    }
+
+    /**
+     *  Keeps the loop tree valid after BasicBlock::SplitOn: the second part of the block belongs to the same
+     *  loop and takes the successors, so it becomes the latch or the preheader instead of the first part.
+     */
+    void AddSplitBlock(BasicBlock *bb, BasicBlock *second_bb) {
+        assert(HasBlock(bb));
+        AddLoopBlock(second_bb);
+        for (auto *succ: second_bb->GetSuccs()) {
+            auto *succ_loop = succ->GetLoop();
+            if (succ_loop == nullptr || succ_loop->GetHeader() != succ) {
+                continue;
+            }
+            succ_loop->ReplaceBackEdge(bb, second_bb);
+            if (succ_loop->preheader_ == bb) {
+                succ_loop->preheader_ = second_bb;
+            }
+        }
+    }
+
+    /**
+     *  Copies the loop and its inner loops for the cloned body, clones are indexed by the ids of the original
+     *  blocks and every block of the loop must be cloned. The copy is added to the same out loop, so it is a
+     *  sibling of the original one. The preheader is copied only if it is cloned too.
+     */
+    Loop *Clone(const BlocksVector &clones) {
+        assert(!is_root_ && out_loop_ != nullptr);
+        auto *graph = header_->GetGraph();
+        auto clone_of = [&clones](BasicBlock *bb) {
+            assert(bb->GetId() < clones.size() && clones[bb->GetId()] != nullptr);
+            return clones[bb->GetId()];
+        };
+        Loop *root_clone = nullptr;
+        // loops to copy with the copies of their out loops, the nesting may be deep
+        std::vector<std::pair<Loop *, Loop *>> stack{{this, out_loop_}};
+        while (!stack.empty()) {
+            auto [loop, out_clone] = stack.back();
+            stack.pop_back();
+            auto *clone = graph->NewLoop(clone_of(loop->header_));
+            if (loop->preheader_ != nullptr && loop->preheader_->GetId() < clones.size()) {
+                clone->preheader_ = clones[loop->preheader_->GetId()];
+            }
+            for (auto *bb: loop->blocks_) {
+                clone->AddLoopBlock(clone_of(bb));
+            }
+            for (auto *back_edge: loop->back_edges_) {
+                clone->AddBackEdge(clone_of(back_edge));
+            }
+            clone->is_irreducible_ = loop->is_irreducible_;
+            clone->depth_ = loop->depth_;
+            clone->SetOutLoop(out_clone);
+            out_clone->AddInLoop(clone);
+            for (auto it = loop->in_loops_.rbegin(); it != loop->in_loops_.rend(); ++it) {
+                stack.emplace_back(*it, clone);
+            }
+            if (root_clone == nullptr) {
+                root_clone = clone;
+            }
+        }
+        return root_clone;
+    }
+
 private:
     size_t id_;
 
@@ -95,6 +195,7 @@ private:
     BlocksVector blocks_;
     std::vector<Loop *> in_loops_;
     Loop *out_loop_{nullptr};
+    uint32_t depth_{0};
 
     bool is_irreducible_{false};
     bool is_root_{false};
@@ -6,36 +6,37 @@
 
 namespace compiler::passes {
 
+// Loops are allocated in the graph, so they outlive the analyzer and stay valid until the next run
 class LoopAnalyzer final : public Pass {
 public:
-    explicit LoopAnalyzer(Graph *graph) : Pass(graph) {
-        holder_.reserve(graph->GetBlocksNum());  // Allocate memory
-    }
+    explicit LoopAnalyzer(Graph *graph) : Pass(graph) {}
 
     bool Run() override;
 
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::All();
+    }
+
     ~LoopAnalyzer() override = default;
 
 private:
-    bool CollectBackEdges(BasicBlock *bb);
+    // grey marks the blocks on the DFS stack, black marks the visited ones
+    bool CollectBackEdges(Marker grey, Marker black);
 
     void CreateNewBackEdge(BasicBlock *header, BasicBlock *back_edge);
 
-    bool PopulateLoops();
+    bool PopulateLoops(Marker reachable);
 
-    bool LoopSearch(BasicBlock *bb, Loop *loop);
+    // Walks the reachable predecessors backwards from the back edges of the loop up to its header
+    bool LoopSearch(Loop *loop, Marker visited, Marker reachable);
 
     bool BuildLoopTree();
 
-    Loop *AllocateLoop(BasicBlock *header);
+    void CalcLoopsDepth(Loop *root_loop);
 
-    void CleanMarkers();
+    Loop *AllocateLoop(BasicBlock *header);
 
     Loop *CreateRootLoop();
-
-private:
-    std::vector <Loop> holder_;
-    BasicBlock root_preheader_;
 };
 
 }  // namespace compiler::passes
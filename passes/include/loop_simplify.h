@@ -0,0 +1,48 @@
+#ifndef COMPILER_LOOP_SIMPLIFY_H
+#define COMPILER_LOOP_SIMPLIFY_H
+
+#include "pass.h"
+#include "loop.h"
+
+namespace compiler::passes {
+
+/**
+ *  Brings the reducible loops to the canonical form which the passes moving code out of loops rely on:
+ *  - the header has a single predecessor outside the loop, the preheader, which jumps only to the header;
+ *  - the header has a single back edge, the latch;
+ *  - every exit block is dedicated, i.e. all its predecessors are in the loop.
+ *  Empty blocks are inserted on the edges where it is needed. Loops and the dominator tree are updated in place,
+ *  irreducible loops are left as they are.
+ */
+class LoopSimplify final : public Pass {
+public:
+    explicit LoopSimplify(Graph *graph) : Pass(graph) {}
+
+    bool Run() override;
+
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::None().Preserve(Analysis::DOM_TREE).Preserve(Analysis::LOOP_INFO);
+    }
+
+    ~LoopSimplify() override = default;
+
+private:
+    void SimplifyLoop(Loop *loop);
+
+    void InsertPreHeader(Loop *loop);
+
+    void MergeLatches(Loop *loop);
+
+    void MakeDedicatedExits(Loop *loop);
+
+    // Inserts an empty block in the given loop on the edges from preds to succ
+    BasicBlock *SplitEdges(const BlocksVector &preds, BasicBlock *succ, Loop *loop);
+
+    // CFG edits of all the loops, the dominator tree is updated once for them
+    std::vector<CfgUpdate> cfg_updates_;
+    BlocksVector new_blocks_;
+};
+
+}  // namespace compiler::passes
+
+#endif //COMPILER_LOOP_SIMPLIFY_H
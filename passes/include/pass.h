@@ -2,7 +2,9 @@
 #define OPTIMIZER_PASS_H
 
 #include <unordered_set>
+#include <unordered_map>
 #include <set>
+#include <limits>
 
 #include "graph.h"
 #include "loop.h"
@@ -17,6 +19,11 @@ public:
 
     virtual bool Run() = 0;
 
+    // Analyses which stay valid after the pass, see AnalysisManager::RunPass
+    [[nodiscard]] virtual PreservedAnalyses GetPreservedAnalyses() const {
+        return PreservedAnalyses::None();
+    }
+
     virtual ~Pass() = default;
 
 protected:
@@ -30,16 +37,32 @@ public:
 
     bool Run() override;
 
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::All();
+    }
+
     ~Traversal() override = default;
 
-    BlocksVector getDFS(bool need_to_rerun = false);
+    /**
+     *  Returned blocks are cached in the graph until the CFG is changed, so the walk is done only if the cache
+     *  is invalid or the rerun is requested. The reference is invalidated by the next walk of the graph.
+     */
+    const BlocksVector &getDFS(bool need_to_rerun = false);
 
-    BlocksVector getRPO(bool need_to_rerun = false);
+    const BlocksVector &getRPO(bool need_to_rerun = false);
+};
 
-private:
-    bool DFSWalk(BasicBlock *bb, IdSet &discovered_bbs);
 
-    BlocksVector dfs_bbs_;
+// Edge which was inserted to or removed from the CFG after the dominator tree had been built
+struct CfgUpdate {
+    enum class Kind : uint8_t {
+        INSERT,
+        REMOVE
+    };
+
+    Kind kind;
+    BasicBlock *from;
+    BasicBlock *to;
 };
 
 
@@ -49,8 +72,20 @@ public:
 
     bool Run() override;
 
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::All();
+    }
+
     ~DomTree() override = default;
 
+    /**
+     *  Brings the valid tree up to date after a batch of CFG edits, the CFG must already be edited. Blocks which
+     *  weren't in the graph when the tree was built (split off or inlined ones) are passed in new_blocks.
+     *  Only the subtree of the nearest common dominator of the edited edges is rebuilt, the whole tree is
+     *  rebuilt if the tree is invalid or the edits make a block unreachable or a formerly unreachable one reachable.
+     */
+    bool ApplyUpdates(const std::vector<CfgUpdate> &updates, const BlocksVector &new_blocks);
+
 private:
     bool SlowDomTree();
 
@@ -58,7 +93,23 @@ private:
 
     static std::set<size_t> CalcDifference(Graph *graph, size_t rm_id, const std::set<size_t> &ids);
 
-    static BasicBlock *CalcImmDominator(const BlocksVector &doms);
+    using DomsMap = std::unordered_map<BasicBlock *, BlocksVector>;
+
+    static BasicBlock *CalcImmDominator(const BlocksVector &doms, const DomsMap &all_doms);
+
+    // Pre and post numbers of the dominator tree DFS for the constant time dominance check
+    void NumberDomTree();
+
+    // Common dominator of two blocks given by RPO indices
+    static size_t Intersect(const std::vector<size_t> &idoms, size_t lhs, size_t rhs);
+
+    // Common dominator of two blocks in the built tree
+    static BasicBlock *FindCommonDominator(BasicBlock *lhs, BasicBlock *rhs);
+
+    // Rebuilds immediate dominators of the blocks of the region which is entered only through its root
+    bool RebuildRegion(BasicBlock *region_root, const BlocksVector &new_blocks);
+
+    static constexpr size_t UNDEF_IDX = std::numeric_limits<size_t>::max();
 
 private:
     bool is_slow_{false};
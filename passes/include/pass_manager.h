@@ -0,0 +1,66 @@
+#ifndef COMPILER_PASS_MANAGER_H
+#define COMPILER_PASS_MANAGER_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "pass.h"
+
+namespace compiler::passes {
+
+// Reachable blocks and their instructions
+struct IrSize {
+    size_t blocks_num{0};
+    size_t instrs_num{0};
+};
+
+struct PassStats {
+    std::string name;
+    bool is_succeeded{false};
+    std::chrono::nanoseconds time{0};
+    storage::AllocStats alloc_delta;  // change of the graph allocator totals made by the pass
+    IrSize size_before;
+    IrSize size_after;
+};
+
+/**
+ *  Runs the passes one by one on the graph and measures every run. Analyses which a pass doesn't preserve
+ *  are invalidated after it, see AnalysisManager::RunPass.
+ */
+class PassManager final {
+public:
+    explicit PassManager(Graph *graph) : graph_(graph) {}
+
+    /**
+     *  Appends the passes from a comma separated list of names, e.g. "inline,check-elim". Nothing is added
+     *  and false is returned if some name is unknown.
+     */
+    bool AddPipeline(const std::string &pipeline);
+
+    void AddPass(std::string name, std::unique_ptr<Pass> pass);
+
+    // Stops on the first failed pass
+    bool Run();
+
+    [[nodiscard]] const std::vector<PassStats> &GetStats() const noexcept {
+        return stats_;
+    }
+
+    // Stats of the runs as a JSON array, one object per pass run, time is in nanoseconds
+    [[nodiscard]] std::string GetReport() const;
+
+    // Names accepted by AddPipeline
+    [[nodiscard]] static std::vector<std::string> GetPassNames();
+
+private:
+    IrSize MeasureIr();
+
+    Graph *graph_;
+    std::vector<std::pair<std::string, std::unique_ptr<Pass>>> passes_;
+    std::vector<PassStats> stats_;
+};
+
+}  // namespace compiler::passes
+
+#endif //COMPILER_PASS_MANAGER_H
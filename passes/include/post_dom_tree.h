@@ -0,0 +1,78 @@
+#ifndef COMPILER_POST_DOM_TREE_H
+#define COMPILER_POST_DOM_TREE_H
+
+#include "pass.h"
+
+namespace compiler::passes {
+
+/**
+ *  Post-dominator tree built by Semi-NCA on the reversed CFG. The graph may have several exits (blocks without
+ *  successors) or none, so the tree is rooted in a virtual exit node which succeeds all of them. Results are
+ *  kept in the pass and indexed by block id, they are valid until the CFG is changed.
+ */
+class PostDomTree final : public Pass {
+public:
+    explicit PostDomTree(Graph *graph) : Pass(graph) {}
+
+    bool Run() override;
+
+    [[nodiscard]] PreservedAnalyses GetPreservedAnalyses() const override {
+        return PreservedAnalyses::All();
+    }
+
+    ~PostDomTree() override = default;
+
+    /**
+     *  nullptr if the block is immediately post-dominated by the virtual exit (i.e. it is an exit or its paths
+     *  reach different exits) or if no exit is reachable from the block (an infinite loop).
+     */
+    [[nodiscard]] BasicBlock *GetImmPostDom(BasicBlock *bb) const;
+
+    // Is there a path from the block to an exit, only such blocks are in the tree
+    [[nodiscard]] bool IsInTree(BasicBlock *bb) const;
+
+    // Constant time check by the DFS numbers of the tree like BasicBlock::IsDominatedBy, a block post-dominates itself
+    [[nodiscard]] bool IsPostDominatedBy(BasicBlock *bb, BasicBlock *pdom) const;
+
+    // Blocks immediately post-dominated by the virtual exit
+    [[nodiscard]] const BlocksVector &GetExitChildren() const noexcept {
+        return exit_children_;
+    }
+
+private:
+    void Reset();
+
+    // Preorder walk of the reversed CFG from the virtual exit, fills vertices_, parents_ and numbers_
+    void WalkReversedCfg(const BlocksVector &rpo);
+
+    void CalcImmPostDoms();
+
+    // Path compression of the link-eval forest, returns the vertex with the minimal semidominator on the path
+    size_t Eval(size_t vertex, size_t last_linked);
+
+    void NumberTree();
+
+    [[nodiscard]] size_t GetNumber(BasicBlock *bb) const;
+
+    static constexpr size_t EXIT_NUM = 0;  // number of the virtual exit
+    static constexpr size_t UNDEF_NUM = std::numeric_limits<size_t>::max();
+
+private:
+    // Semi-NCA state, indexed by the preorder number, the virtual exit is nullptr
+    BlocksVector vertices_;
+    std::vector<size_t> parents_;
+    std::vector<size_t> ancestors_;
+    std::vector<size_t> semis_;
+    std::vector<size_t> labels_;
+    std::vector<size_t> idoms_;
+    std::vector<size_t> eval_stack_;
+
+    std::vector<size_t> numbers_;  // preorder numbers indexed by block id
+    std::vector<uint32_t> tree_pre_;  // DFS numbers of the tree indexed by the preorder number
+    std::vector<uint32_t> tree_post_;
+    BlocksVector exit_children_;
+};
+
+}  // namespace compiler::passes
+
+#endif //COMPILER_POST_DOM_TREE_H
@@ -1,5 +1,6 @@
 #include "inlining.h"
 #include "instruction.h"
+#include "analysis_manager.h"
 
 namespace compiler::passes {
 
@@ -9,7 +10,7 @@ bool Inlining::Run() {
         return false;
     }
     if (bbs_in_rpo_.empty()) {
-        bbs_in_rpo_ = passes::Traversal{graph_}.getRPO(true);
+        bbs_in_rpo_ = graph_->GetAnalyses().GetRpo();
     }
     InsnsVec call_insns;
     if (!IsGraphSuitableForInl(call_insns)) {
@@ -19,18 +20,21 @@ bool Inlining::Run() {
     for (auto *insn: call_insns) {
         DoInlineMethod(insn);
     }
-    return true;
+    bool res = !graph_->IsDomTreeValid() || DomTree{graph_, false}.ApplyUpdates(cfg_updates_, new_blocks_);
+    cfg_updates_.clear();
+    new_blocks_.clear();
+    return res;
 }
 
 bool Inlining::IsGraphSuitableForInl(InsnsVec &call_insns) {
     size_t insns_count = 0;
     for (auto *bb: bbs_in_rpo_) {
-        for (auto *insn: bb->GetAllInstrs()) {
+        for (auto *insn: bb->GetInstrs()) {
             if (insn->IsCall()) {
                 call_insns.push_back(insn);
             }
+            ++insns_count;
         }
-        insns_count += bb->GetAllInstrs().size();
     }
     if (insns_count > insns_limit_) {
         return false;
@@ -44,22 +48,26 @@ void Inlining::DoInlineMethod(InstructionBase *caller) {
 
     auto *cur_bb = caller->GetBasicBlock();
     auto second_bb = cur_bb->SplitOn(caller);
+    new_blocks_.push_back(second_bb);
+    for (auto *succ: second_bb->GetSuccs()) {
+        cfg_updates_.push_back({CfgUpdate::Kind::REMOVE, cur_bb, succ});
+        cfg_updates_.push_back({CfgUpdate::Kind::INSERT, second_bb, succ});
+    }
 
     // Move inlined parameters' users to caller inputs' users
     if (caller->HasInputs()) {
         InsnsVec inlined_params;
-        InsnsVec start_block_instrs = inlined_graph->GetRoot()->GetAllInstrs();
-        std::copy_if(start_block_instrs.begin(), start_block_instrs.end(),
-                     std::back_inserter(inlined_params),
-                     [](InstructionBase *instr) { return instr->GetOpcode() == Opcode::PARAMETER; });
-        auto call_args = caller->GetInputs();
-        call_args.erase(call_args.begin());  // call label is not arg of the function
+        for (auto *instr: inlined_graph->GetRoot()->GetInstrs()) {
+            if (instr->GetOpcode() == Opcode::PARAMETER) {
+                inlined_params.push_back(instr);
+            }
+        }
+        auto call_args = caller->GetInputs().subspan(1);  // call label is not arg of the function
         assert(call_args.size() == inlined_params.size());
         for (size_t param_idx = 0; param_idx < call_args.size(); ++param_idx) {
             auto *caller_input = call_args.at(param_idx)->def();
             auto *inl_param = inlined_params.at(param_idx);
             inl_param->ReplaceInputForUsers(caller_input);
-            caller_input->AddUsers(inl_param->GetUsers());
             caller_input->RemoveUser(caller);
         }
     }
@@ -83,12 +91,14 @@ void Inlining::DoInlineMethod(InstructionBase *caller) {
     auto *bb_after_root = inlined_graph->GetRoot()->GetSuccs().front();
     bb_after_root->RemoveFromPreds(inlined_graph->GetRoot()->GetId());
     BasicBlock::AddEdge(cur_bb, bb_after_root);
+    cfg_updates_.push_back({CfgUpdate::Kind::INSERT, cur_bb, bb_after_root});
 
     // Move predecessors of inlined end block to second_bb
     for (auto *pred_bb: inlined_graph->GetEnd()->GetPreds()) {
         assert(pred_bb->GetSuccs().size() == 1);  // predecessor of end block has only one successor
         pred_bb->RemoveFromSuccs(inlined_graph->GetEnd()->GetId());
         BasicBlock::AddEdge(pred_bb, second_bb);
+        cfg_updates_.push_back({CfgUpdate::Kind::INSERT, pred_bb, second_bb});
     }
 
     cur_bb->RemoveLastInstr();  // remove call instr
@@ -106,14 +116,14 @@ void Inlining::ReplaceExitDataFlowEdges(InstructionBase *caller, InstructionBase
             second_bb->SetFirstPhi(ret_result);
         }
         assert(exit_instr->GetInputs().size() == 1);  // ret can be only from one register
-        exit_instr->ReplaceUserForInputs(ret_result);
-        ret_result->SetInputs(exit_instr->GetInputs());
+        ret_result->AddInput(alloc_, InstrArg(*exit_instr->GetInputs().front()));
+        exit_instr->RemoveInputs();
+        caller->ReplaceInputForUsers(ret_result);
     } else if (exit_instr->GetOpcode() == Opcode::RET && inl_ret_count == 1) {
         assert(exit_instr->GetInputs().size() == 1);  // ret can be only from one register
-        for (auto *user : caller->GetUsers()) {
-            exit_instr->ReplaceUserForInputs(user);
-        }
-        caller->ReplaceInputForUsers(exit_instr->GetInputs().front()->def());
+        auto *ret_def = exit_instr->GetInputs().front()->def();
+        exit_instr->RemoveInputs();
+        caller->ReplaceInputForUsers(ret_def);
     } else if (exit_instr->GetOpcode() == Opcode::RET_VOID || exit_instr->GetOpcode() == Opcode::THROW) {
         assert(exit_instr->GetInputs().empty());
     } else {
@@ -123,19 +133,20 @@ void Inlining::ReplaceExitDataFlowEdges(InstructionBase *caller, InstructionBase
 
 void Inlining::MoveConstants(BasicBlock *start_block) {
     auto *curr_start_bb = graph_->GetRoot();
-    for (auto *instr: start_block->GetAllInstrs()) {
+    for (auto *instr: start_block->GetInstrs()) {
         if (instr->GetOpcode() != Opcode::CONSTANT) {
             continue;
         }
         size_t inl_value = instr->GetDst()->num();  // inlined constant value
-        auto curr_instrs = curr_start_bb->GetAllInstrs();
+        auto curr_instrs = curr_start_bb->GetInstrs();
         auto it = std::find_if(curr_instrs.begin(), curr_instrs.end(),
                                [inl_value](InstructionBase *cur_instr) {
                                    return cur_instr->GetOpcode() == Opcode::CONSTANT &&
                                           inl_value == cur_instr->GetDst()->num();
-                               });\
-        if (it == curr_start_bb->GetAllInstrs().end()) {
-            curr_start_bb->InsertInstrAfter(curr_start_bb->GetLastInstr(), *it);
+                               });
+        if (it == curr_instrs.end()) {
+            start_block->RemoveInstr(instr);
+            curr_start_bb->InsertInstrAfter(curr_start_bb->GetLastInstr(), instr);
         } else {
             instr->ReplaceInputForUsers(*it);
         }
@@ -144,12 +155,12 @@ void Inlining::MoveConstants(BasicBlock *start_block) {
 
 void Inlining::ChangeInlBlocksRelation(Graph *inlined_graph) {
     passes::Traversal tr{inlined_graph};
-    BlocksVector rpo = tr.getRPO(true);
-    rpo.erase(rpo.begin());  // erase start block
-    rpo.pop_back();  // erase end block
-    for (auto *inl_bb: rpo) {
-        inl_bb->SetGraph(graph_);
-        inl_bb->RemoveId();
+    const BlocksVector &rpo = tr.getRPO(true);
+    // skip start and end blocks
+    for (size_t i = 1; i + 1 < rpo.size(); ++i) {
+        rpo[i]->SetGraph(graph_);
+        rpo[i]->RemoveId();
+        new_blocks_.push_back(rpo[i]);
     }
 }
 
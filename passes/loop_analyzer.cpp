@@ -11,15 +11,23 @@ bool LoopAnalyzer::Run() {
         }
     }
     assert(graph_->IsDomTreeValid());
-    CleanMarkers();
-    if (!CollectBackEdges(graph_->GetRoot())) {
-        std::cerr << "Error! CollectBackEdges went wrong\n";
-        return false;
+    // loops of the previous run are dead, the analyzer assigns loops only to the blocks without them
+    for (auto *bb: Traversal{graph_}.getRPO()) {
+        bb->SetLoop(nullptr);
     }
-    CleanMarkers();
-    if (!PopulateLoops()) {
-        std::cerr << "Error! PopulateLoops went wrong\n";
-        return false;
+    graph_->ClearLoops();
+    {
+        MarkerHolder grey{graph_};
+        // black marks the blocks reachable from the root, the others mustn't get into the loops
+        MarkerHolder black{graph_};
+        if (!CollectBackEdges(grey.Get(), black.Get())) {
+            std::cerr << "Error! CollectBackEdges went wrong\n";
+            return false;
+        }
+        if (!PopulateLoops(black.Get())) {
+            std::cerr << "Error! PopulateLoops went wrong\n";
+            return false;
+        }
     }
     if (!BuildLoopTree()) {
         std::cerr << "Error! BuildLoopTree went wrong\n";
@@ -29,17 +37,30 @@ bool LoopAnalyzer::Run() {
     return true;
 }
 
-bool LoopAnalyzer::CollectBackEdges(BasicBlock *bb) {
-    bb->AddColor(Marker::Color::GREY);
-    bb->AddColor(Marker::Color::BLACK);
-    for (auto *succ: bb->GetSuccs()) {
-        if (succ->GetMarker().HasGrey()) {
-            CreateNewBackEdge(succ, bb);
-        } else if (!succ->GetMarker().HasBlack()) {
-            CollectBackEdges(succ);
+bool LoopAnalyzer::CollectBackEdges(Marker grey, Marker black) {
+    // explicit stack of the blocks and their next successors, generated graphs are too deep for the recursion
+    std::vector<std::pair<BasicBlock *, size_t>> stack;
+    auto *root = graph_->GetRoot();
+    root->SetMarker(grey);
+    root->SetMarker(black);
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+        auto &[bb, succ_idx] = stack.back();
+        auto succs = bb->GetSuccs();
+        if (succ_idx < succs.size()) {
+            auto *succ = succs[succ_idx++];
+            if (succ->IsMarked(grey)) {
+                CreateNewBackEdge(succ, bb);
+            } else if (!succ->IsMarked(black)) {
+                succ->SetMarker(grey);
+                succ->SetMarker(black);
+                stack.emplace_back(succ, 0);
+            }
+            continue;
         }
+        bb->ResetMarker(grey);
+        stack.pop_back();
     }
-    bb->RemoveColor(Marker::Color::GREY);
     return true;
 }
 
@@ -48,6 +69,11 @@ void LoopAnalyzer::CreateNewBackEdge(BasicBlock *header, BasicBlock *back_edge)
     if (loop == nullptr) {
         loop = AllocateLoop(header);
     }
+    // both edges of a branch might go to the header
+    auto back_edges = loop->GetBackEdges();
+    if (std::find(back_edges.begin(), back_edges.end(), back_edge) != back_edges.end()) {
+        return;
+    }
 
     loop->AddBackEdge(back_edge);
     if (!back_edge->IsDominatedBy(header)) {
@@ -56,26 +82,14 @@ void LoopAnalyzer::CreateNewBackEdge(BasicBlock *header, BasicBlock *back_edge)
 }
 
 Loop *LoopAnalyzer::AllocateLoop(BasicBlock *header) {
-    size_t loop_id = holder_.size();
-    assert(std::find_if(holder_.begin(), holder_.end(),
-                        [loop_id](const Loop &loop) { return loop_id == loop.GetId(); }) ==
-           holder_.end());
-    holder_.emplace_back(loop_id, header);
-    holder_.back().AddLoopBlock(header);
-    return &holder_.back();
-}
-
-void LoopAnalyzer::CleanMarkers() {
-    auto dfs_blocks = Traversal{graph_}.getDFS(true);
-    for (auto *bb: dfs_blocks) {
-        bb->RemoveColor(Marker::Color::GREY);
-        bb->RemoveColor(Marker::Color::BLACK);
-    }
+    auto *loop = graph_->NewLoop(header);
+    loop->AddLoopBlock(header);
+    return loop;
 }
 
-bool LoopAnalyzer::PopulateLoops() {
-    auto dfs_blocks = Traversal{graph_}.getDFS(true);
-    for (auto bb: dfs_blocks) {
+bool LoopAnalyzer::PopulateLoops(Marker reachable) {
+    Traversal tr{graph_};
+    for (auto bb: tr.getDFS()) {
         if (bb->GetLoop() == nullptr || !bb->IsLoopHeader()) {
             continue;
         }
@@ -87,36 +101,47 @@ bool LoopAnalyzer::PopulateLoops() {
                 }
             }
         } else {
-            bb->AddColor(Marker::Color::BLACK);
-            for (auto back_edge : loop->GetBackEdges()) {
-                if (!LoopSearch(back_edge, loop)) {
-                    std::cerr << "Error! LoopSearch went wrong\n";
-                    return false;
-                }
+            // every loop is searched with its own marker, so nothing is cleaned between the loops
+            MarkerHolder visited{graph_};
+            bb->SetMarker(visited.Get());
+            if (!LoopSearch(loop, visited.Get(), reachable)) {
+                std::cerr << "Error! LoopSearch went wrong\n";
+                return false;
             }
-            CleanMarkers();
         }
     }
     return true;
 }
 
-bool LoopAnalyzer::LoopSearch(BasicBlock *bb, Loop *loop) {
-    if (!bb->GetMarker().HasBlack()) {
-        bb->AddColor(Marker::Color::BLACK);
+bool LoopAnalyzer::LoopSearch(Loop *loop, Marker visited, Marker reachable) {
+    BlocksVector stack(loop->GetBackEdges().begin(), loop->GetBackEdges().end());
+    while (!stack.empty()) {
+        auto *bb = stack.back();
+        stack.pop_back();
+        if (bb->IsMarked(visited)) {
+            continue;
+        }
+        bb->SetMarker(visited);
 
-        if (bb->GetLoop() == nullptr) {
+        auto *bb_loop = bb->GetLoop();
+        if (bb_loop == nullptr) {
             loop->AddLoopBlock(bb);
-        } else if (bb->GetLoop()->GetHeader() != loop->GetHeader()) {
-            if (bb->GetLoop()->GetOutLoop() == nullptr) {
-                bb->GetLoop()->SetOutLoop(loop);
-                loop->AddInLoop(bb->GetLoop());
+        } else if (bb_loop->GetHeader() != loop->GetHeader()) {
+            if (bb_loop->GetOutLoop() == nullptr) {
+                bb_loop->SetOutLoop(loop);
+                loop->AddInLoop(bb_loop);
+            }
+            // inner loops are already populated, a reducible one is entered only through its header,
+            // so its body is skipped and every block is walked once per nesting level at most
+            if (!bb_loop->IsIrreducible() && !bb->IsLoopHeader()) {
+                stack.push_back(bb_loop->GetHeader());
+                continue;
             }
         }
 
         for (auto *pred : bb->GetPreds()) {
-            if (!LoopSearch(pred, loop)) {
-                std::cerr << "Error! LoopSearch for predecessor went wrong\n";
-                return false;
+            if (!pred->IsMarked(visited) && pred->IsMarked(reachable)) {
+                stack.push_back(pred);
             }
         }
     }
@@ -125,25 +150,39 @@ bool LoopAnalyzer::LoopSearch(BasicBlock *bb, Loop *loop) {
 
 bool LoopAnalyzer::BuildLoopTree() {
     Loop *root_loop = CreateRootLoop();
-    auto dfs_blocks = Traversal{graph_}.getDFS(true);
-    for (auto bb: dfs_blocks) {
+    Traversal tr{graph_};
+    for (auto bb: tr.getDFS()) {
         if (bb->GetLoop() == nullptr) {
             root_loop->AddLoopBlock(bb);
-        } else if (bb->GetLoop()->GetOutLoop() == nullptr) {
+        } else if (bb->GetLoop() != root_loop && bb->GetLoop()->GetOutLoop() == nullptr) {
             bb->GetLoop()->SetOutLoop(root_loop);
             root_loop->AddInLoop(bb->GetLoop());
         }
     }
+    CalcLoopsDepth(root_loop);
     return true;
 }
 
+void LoopAnalyzer::CalcLoopsDepth(Loop *root_loop) {
+    root_loop->SetDepth(0);
+    std::vector<Loop *> stack{root_loop};
+    while (!stack.empty()) {
+        auto *loop = stack.back();
+        stack.pop_back();
+        for (auto *in_loop: loop->GetInLoops()) {
+            in_loop->SetDepth(loop->GetDepth() + 1);
+            stack.push_back(in_loop);
+        }
+    }
+}
+
 Loop *LoopAnalyzer::CreateRootLoop() {
     Loop *root_loop;
     if (graph_->GetRoot()->GetLoop() != nullptr) {
-        root_preheader_ = BasicBlock{};
-        graph_->MoveRoot(&root_preheader_);
-        root_loop = AllocateLoop(&root_preheader_);
-        root_loop->SetPreHeader(&root_preheader_);
+        auto *preheader = graph_->GetAllocator()->New<BasicBlock>();
+        graph_->MoveRoot(preheader);
+        root_loop = AllocateLoop(preheader);
+        root_loop->SetPreHeader(preheader);
     } else {
         root_loop = AllocateLoop(graph_->GetRoot());
     }
@@ -0,0 +1,142 @@
+#include <algorithm>
+
+#include "include/loop_simplify.h"
+#include "include/analysis_manager.h"
+
+namespace compiler::passes {
+
+bool LoopSimplify::Run() {
+    auto &analyses = graph_->GetAnalyses();
+    // the tree is updated in place, so it is required before the loops, which would build it otherwise
+    if (!analyses.RequireDomTree()) {
+        std::cerr << "Error! Dominator tree building is corrupted\n";
+        return false;
+    }
+    auto *root_loop = analyses.GetRootLoop();
+    if (root_loop == nullptr) {
+        std::cerr << "Error! Loop analysis went wrong\n";
+        return false;
+    }
+    // inner loops go first, so the outer ones see the blocks inserted for them, reversed preorder is enough for that
+    std::vector<Loop *> loops;
+    std::vector<Loop *> stack{root_loop};
+    while (!stack.empty()) {
+        auto *loop = stack.back();
+        stack.pop_back();
+        loops.push_back(loop);
+        stack.insert(stack.end(), loop->GetInLoops().begin(), loop->GetInLoops().end());
+    }
+    for (auto it = loops.rbegin(); it != loops.rend(); ++it) {
+        auto *loop = *it;
+        // the header of a reducible loop might be taken by an irreducible one as its back edge
+        if (!loop->IsRoot() && !loop->IsIrreducible() && loop->GetHeader()->GetLoop() == loop) {
+            SimplifyLoop(loop);
+        }
+    }
+    bool res = DomTree{graph_, false}.ApplyUpdates(cfg_updates_, new_blocks_);
+    cfg_updates_.clear();
+    new_blocks_.clear();
+    return res;
+}
+
+void LoopSimplify::SimplifyLoop(Loop *loop) {
+    InsertPreHeader(loop);
+    MergeLatches(loop);
+    MakeDedicatedExits(loop);
+}
+
+void LoopSimplify::InsertPreHeader(Loop *loop) {
+    auto *header = loop->GetHeader();
+    BlocksVector outside_preds;
+    for (auto *pred: header->GetPreds()) {
+        if (!loop->Contains(pred) && std::find(outside_preds.begin(), outside_preds.end(), pred) ==
+                                     outside_preds.end()) {
+            outside_preds.push_back(pred);
+        }
+    }
+    if (outside_preds.empty()) {
+        return;
+    }
+    if (outside_preds.size() == 1 && outside_preds.front()->GetSuccs().size() == 1) {
+        loop->SetPreHeader(outside_preds.front());
+        return;
+    }
+    loop->SetPreHeader(SplitEdges(outside_preds, header, loop->GetOutLoop()));
+}
+
+void LoopSimplify::MergeLatches(Loop *loop) {
+    if (loop->GetBackEdges().size() < 2) {
+        return;
+    }
+    BlocksVector latches(loop->GetBackEdges().begin(), loop->GetBackEdges().end());
+    SplitEdges(latches, loop->GetHeader(), loop);
+    assert(loop->GetBackEdges().size() == 1);
+}
+
+void LoopSimplify::MakeDedicatedExits(Loop *loop) {
+    // exits of the inner loops which leave this loop too are its exits
+    BlocksVector exits;
+    MarkerHolder is_exit{graph_};
+    std::vector<Loop *> loops{loop};
+    while (!loops.empty()) {
+        auto *cur_loop = loops.back();
+        loops.pop_back();
+        loops.insert(loops.end(), cur_loop->GetInLoops().begin(), cur_loop->GetInLoops().end());
+        for (auto *bb: cur_loop->GetLoopBlocks()) {
+            for (auto *succ: bb->GetSuccs()) {
+                if (!succ->IsMarked(is_exit.Get()) && !loop->Contains(succ)) {
+                    succ->SetMarker(is_exit.Get());
+                    exits.push_back(succ);
+                }
+            }
+        }
+    }
+
+    for (auto *exit: exits) {
+        BlocksVector loop_preds;
+        bool is_dedicated = true;
+        for (auto *pred: exit->GetPreds()) {
+            if (!loop->Contains(pred)) {
+                is_dedicated = false;
+            } else if (std::find(loop_preds.begin(), loop_preds.end(), pred) == loop_preds.end()) {
+                loop_preds.push_back(pred);
+            }
+        }
+        if (is_dedicated) {
+            continue;
+        }
+        // the new exit is in the innermost loop which contains both this loop and the old exit
+        auto *exit_loop = loop->GetOutLoop();
+        while (!exit_loop->Contains(exit) && exit_loop->GetOutLoop() != nullptr) {
+            exit_loop = exit_loop->GetOutLoop();
+        }
+        SplitEdges(loop_preds, exit, exit_loop);
+    }
+}
+
+BasicBlock *LoopSimplify::SplitEdges(const BlocksVector &preds, BasicBlock *succ, Loop *loop) {
+    auto *new_bb = graph_->GetAllocator()->New<BasicBlock>();
+    new_bb->SetGraph(graph_);
+    loop->AddLoopBlock(new_bb);
+    new_blocks_.push_back(new_bb);
+
+    auto *succ_loop = succ->GetLoop();
+    bool is_header = succ_loop != nullptr && succ_loop->GetHeader() == succ;
+    for (auto *pred: preds) {
+        // both edges of a branch might go to the block
+        for (auto succs = pred->GetSuccs(); std::find(succs.begin(), succs.end(), succ) != succs.end();
+             succs = pred->GetSuccs()) {
+            pred->ReplaceSucc(succ, new_bb);
+            cfg_updates_.push_back({CfgUpdate::Kind::REMOVE, pred, succ});
+            cfg_updates_.push_back({CfgUpdate::Kind::INSERT, pred, new_bb});
+        }
+        if (is_header) {
+            succ_loop->ReplaceBackEdge(pred, new_bb);
+        }
+    }
+    BasicBlock::AddEdge(new_bb, succ);
+    cfg_updates_.push_back({CfgUpdate::Kind::INSERT, new_bb, succ});
+    return new_bb;
+}
+
+}  // namespace compiler::passes
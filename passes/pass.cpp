@@ -8,43 +8,57 @@ namespace compiler::passes {
 /*========================= Traversal ============================*/
 /*================================================================*/
 bool Traversal::Run() {
-    dfs_bbs_.reserve(graph_->GetBlocksNum());
-    IdSet discovered_bbs;
-    bool res = DFSWalk(graph_->GetRoot(), discovered_bbs);
-    if (res) {
-        graph_->MakeRpoValid();
-    } else {
+    if (graph_->GetRoot() == nullptr) {
         std::cerr << "Error! DFS Walk went wrong\n";
+        return false;
     }
-    return res;
-}
+    BlocksVector dfs_bbs;
+    dfs_bbs.reserve(graph_->GetBlocksNum());
+    std::vector<bool> discovered_bbs(graph_->GetBlockIdsNum());
+    auto discover = [&discovered_bbs](BasicBlock *bb) {
+        size_t id = bb->GetId();  // might be given just now, so the set can grow
+        if (id >= discovered_bbs.size()) {
+            discovered_bbs.resize(id + 1);
+        }
+        bool is_new = !discovered_bbs[id];
+        discovered_bbs[id] = true;
+        return is_new;
+    };
 
-bool Traversal::DFSWalk(BasicBlock *bb, IdSet &discovered_bbs) {
-    if (discovered_bbs.find(bb->GetId()) != discovered_bbs.end()) {
-        return true;
-    }
-    discovered_bbs.insert(bb->GetId());
-    for (auto *succ: bb->GetSuccs()) {
-        DFSWalk(succ, discovered_bbs);
+    // Explicit stack of the blocks with the index of the next successor to walk to, so long CFGs don't
+    // overflow the call stack. Blocks are put to dfs_bbs in post order like in the recursive walk.
+    std::vector<std::pair<BasicBlock *, size_t>> stack;
+    discover(graph_->GetRoot());
+    stack.emplace_back(graph_->GetRoot(), 0);
+    while (!stack.empty()) {
+        auto &[bb, succ_idx] = stack.back();
+        auto succs = bb->GetSuccs();
+        if (succ_idx < succs.size()) {
+            BasicBlock *succ = succs[succ_idx++];
+            if (discover(succ)) {
+                stack.emplace_back(succ, 0);
+            }
+            continue;
+        }
+        dfs_bbs.push_back(bb);
+        stack.pop_back();
     }
-    dfs_bbs_.emplace_back(bb);
+    graph_->SetDfsOrder(std::move(dfs_bbs));
     return true;
 }
 
-BlocksVector Traversal::getDFS(bool need_to_rerun) {
+const BlocksVector &Traversal::getDFS(bool need_to_rerun) {
     if (need_to_rerun || !graph_->IsRpoValid()) {
         Run();
     }
-    return dfs_bbs_;
+    return graph_->GetDfsOrder();
 }
 
-BlocksVector Traversal::getRPO(bool need_to_rerun) {
+const BlocksVector &Traversal::getRPO(bool need_to_rerun) {
     if (need_to_rerun || !graph_->IsRpoValid()) {
         Run();
     }
-    BlocksVector rpo_bbs = dfs_bbs_;
-    std::reverse(rpo_bbs.begin(), rpo_bbs.end());
-    return rpo_bbs;
+    return graph_->GetRpoOrder();
 }
 
 /*==============================================================*/
@@ -53,26 +67,58 @@ BlocksVector Traversal::getRPO(bool need_to_rerun) {
 bool DomTree::Run() {
     bool res = is_slow_ ? SlowDomTree() : FastDomTree();
     if (res) {
+        NumberDomTree();
         graph_->MakeDomTreeValid();
     }
     return res;
 }
 
+void DomTree::NumberDomTree() {
+    uint32_t counter = 0;
+    // blocks with the index of the next child to visit
+    std::vector<std::pair<BasicBlock *, size_t>> stack;
+    stack.emplace_back(graph_->GetRoot(), 0);
+    std::vector<uint32_t> pre_numbers{++counter};
+    while (!stack.empty()) {
+        auto &[bb, child_idx] = stack.back();
+        auto children = bb->GetDomChildren();
+        if (child_idx < children.size()) {
+            stack.emplace_back(children[child_idx++], 0);
+            pre_numbers.push_back(++counter);
+            continue;
+        }
+        bb->SetDomNumbers(pre_numbers.back(), ++counter);
+        pre_numbers.pop_back();
+        stack.pop_back();
+    }
+}
+
 bool DomTree::SlowDomTree() {
-    auto dfs_blocks = Traversal{graph_}.getDFS(true);
+    // copy, CalcDifference reruns the traversal of the graph
+    BlocksVector dfs_blocks = Traversal{graph_}.getDFS(true);
+    for (auto bb: dfs_blocks) {
+        bb->ClearDomInfo();
+    }
+    // all the dominators of every block, only while the tree is built
+    DomsMap doms;
+    for (auto bb: dfs_blocks) {
+        doms[bb].push_back(graph_->GetRoot());
+    }
     for (auto bb: dfs_blocks) {
-        bb->AddToDoms({graph_->GetRoot()});
         for (auto id: CalcDifference(graph_, bb->GetId(), BasicBlock::CollectIds(dfs_blocks))) {
-            graph_->FindBlock(id)->AddToDoms({bb});
+            doms[graph_->FindBlock(id)].push_back(bb);
         }
     }
     // immediate dominators calculation
     for (auto bb: dfs_blocks) {
-        auto *immDom = CalcImmDominator(bb->GetDomBlocks());
+        auto *immDom = CalcImmDominator(doms[bb], doms);
         if (!immDom) {
             return false;
         }
         bb->SetImmDom(immDom);
+        if (bb != graph_->GetRoot()) {
+            immDom->AddDomChild(bb);
+        }
     }
     return true;
 }
@@ -88,14 +134,18 @@ std::set<size_t> DomTree::CalcDifference(Graph *graph, size_t rm_id, const std::
     return intersect;
 }
 
-BasicBlock *DomTree::CalcImmDominator(const BlocksVector &doms) {
+BasicBlock *DomTree::CalcImmDominator(const BlocksVector &doms, const DomsMap &all_doms) {
+    auto is_dominated_by = [&all_doms](BasicBlock *bb, BasicBlock *dom) {
+        const auto &bb_doms = all_doms.at(bb);
+        return std::find(bb_doms.begin(), bb_doms.end(), dom) != bb_doms.end();
+    };
     for (size_t i = 0; i < doms.size(); ++i) {
         bool is_imm_dom = true;
         for (size_t j = 0; j < doms.size(); ++j) {
             if (i == j) {
                 continue;
             }
-            if (!doms[i]->IsDominatedBy(doms[j])) {
+            if (!is_dominated_by(doms[i], doms[j])) {
                 is_imm_dom = false;
             }
         }
@@ -106,8 +156,208 @@ BasicBlock *DomTree::CalcImmDominator(const BlocksVector &doms) {
     return nullptr;
 }
 
+/**
+ *  Cooper, Harvey, Kennedy "A Simple, Fast Dominance Algorithm": immediate dominators are refined in RPO
+ *  until the fixed point, the CFG is only read. Blocks are numbered by their RPO index, so the dominator
+ *  of a block always has the smaller number.
+ */
 bool DomTree::FastDomTree() {
-    return SlowDomTree();  // TODO(): Implement fast version
+    const BlocksVector &rpo = Traversal{graph_}.getRPO();
+    if (rpo.empty()) {
+        return false;
+    }
+    std::vector<size_t> rpo_idx(graph_->GetBlockIdsNum(), UNDEF_IDX);  // indexed by block id
+    for (size_t i = 0; i < rpo.size(); ++i) {
+        rpo[i]->ClearDomInfo();
+        rpo_idx[rpo[i]->GetId()] = i;
+    }
+    auto get_rpo_idx = [&rpo_idx](BasicBlock *bb) {
+        // unreachable blocks might have no id
+        return bb->HasId() && bb->GetId() < rpo_idx.size() ? rpo_idx[bb->GetId()] : UNDEF_IDX;
+    };
+
+    std::vector<size_t> idoms(rpo.size(), UNDEF_IDX);
+    idoms[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); ++i) {
+            size_t new_idom = UNDEF_IDX;
+            for (auto *pred: rpo[i]->GetPreds()) {
+                size_t pred_idx = get_rpo_idx(pred);
+                if (pred_idx == UNDEF_IDX || idoms[pred_idx] == UNDEF_IDX) {
+                    continue;  // not processed yet
+                }
+                new_idom = new_idom == UNDEF_IDX ? pred_idx : Intersect(idoms, pred_idx, new_idom);
+            }
+            if (new_idom != idoms[i]) {
+                idoms[i] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    auto *root = rpo.front();
+    root->SetImmDom(root);
+    for (size_t i = 1; i < rpo.size(); ++i) {
+        assert(idoms[i] != UNDEF_IDX);
+        rpo[i]->SetImmDom(rpo[idoms[i]]);
+        rpo[idoms[i]]->AddDomChild(rpo[i]);
+    }
+    return true;
+}
+
+/**
+ *  Blocks whose dominators might change are in the subtree of the nearest common dominator of the edited
+ *  edges' ends. The subtree is entered only through its root, so the rest blocks keep their dominators while
+ *  every block of the subtree stays reachable, and the new blocks join the subtree since all their edges lead
+ *  to it. The kind of the edit doesn't matter for this, so insertions and removals are handled the same way.
+ */
+bool DomTree::ApplyUpdates(const std::vector<CfgUpdate> &updates, const BlocksVector &new_blocks) {
+    if (!graph_->IsDomTreeValid()) {
+        return Run();
+    }
+    MarkerHolder new_marker{graph_};
+    for (auto *bb: new_blocks) {
+        bb->ClearDomInfo();  // inlined blocks keep the tree of the callee
+        bb->SetMarker(new_marker.Get());
+    }
+    if (graph_->GetRoot()->IsMarked(new_marker.Get())) {
+        return Run();
+    }
+    auto is_in_tree = [&new_marker](BasicBlock *bb) {
+        return !bb->IsMarked(new_marker.Get()) && bb->GetImmDom() != nullptr;
+    };
+
+    BasicBlock *region_root = nullptr;
+    auto add_to_region = [&region_root](BasicBlock *bb) {
+        region_root = region_root == nullptr ? bb : FindCommonDominator(region_root, bb);
+    };
+    for (const auto &update: updates) {
+        if (is_in_tree(update.from)) {
+            add_to_region(update.from);
+        }
+        if (is_in_tree(update.to)) {
+            add_to_region(update.to);
+        } else if (update.kind == CfgUpdate::Kind::INSERT && !update.to->IsMarked(new_marker.Get())) {
+            return Run();  // edge leads to the formerly unreachable block
+        }
+    }
+    for (auto *bb: new_blocks) {
+        for (auto *pred: bb->GetPreds()) {
+            if (is_in_tree(pred)) {
+                add_to_region(pred);
+            }
+        }
+        for (auto *succ: bb->GetSuccs()) {
+            if (is_in_tree(succ)) {
+                add_to_region(succ);
+            } else if (!succ->IsMarked(new_marker.Get())) {
+                return Run();
+            }
+        }
+    }
+    if (region_root == nullptr) {
+        return true;  // reachable blocks aren't touched
+    }
+    return RebuildRegion(region_root, new_blocks) || Run();
+}
+
+BasicBlock *DomTree::FindCommonDominator(BasicBlock *lhs, BasicBlock *rhs) {
+    while (!rhs->IsDominatedBy(lhs)) {
+        lhs = lhs->GetImmDom();
+    }
+    return lhs;
+}
+
+bool DomTree::RebuildRegion(BasicBlock *region_root, const BlocksVector &new_blocks) {
+    MarkerHolder region_marker{graph_};
+    BlocksVector subtree{region_root};
+    for (size_t i = 0; i < subtree.size(); ++i) {
+        subtree[i]->SetMarker(region_marker.Get());
+        auto children = subtree[i]->GetDomChildren();
+        subtree.insert(subtree.end(), children.begin(), children.end());
+    }
+    for (auto *bb: new_blocks) {
+        bb->SetMarker(region_marker.Get());
+    }
+
+    // Iterative DFS inside the region, blocks get their RPO indices after the walk
+    std::unordered_map<BasicBlock *, size_t> rpo_idx;
+    BlocksVector rpo;
+    std::vector<std::pair<BasicBlock *, size_t>> stack;
+    rpo_idx.emplace(region_root, UNDEF_IDX);
+    stack.emplace_back(region_root, 0);
+    while (!stack.empty()) {
+        auto &[bb, succ_idx] = stack.back();
+        auto succs = bb->GetSuccs();
+        if (succ_idx < succs.size()) {
+            BasicBlock *succ = succs[succ_idx++];
+            if (succ->IsMarked(region_marker.Get()) && rpo_idx.emplace(succ, UNDEF_IDX).second) {
+                stack.emplace_back(succ, 0);
+            }
+            continue;
+        }
+        rpo.push_back(bb);
+        stack.pop_back();
+    }
+    std::reverse(rpo.begin(), rpo.end());
+    for (size_t i = 0; i < rpo.size(); ++i) {
+        rpo_idx[rpo[i]] = i;
+    }
+    bool is_subtree_reachable = std::all_of(subtree.begin(), subtree.end(), [&rpo_idx](BasicBlock *bb) {
+        return rpo_idx.count(bb) != 0;
+    });
+    if (!is_subtree_reachable) {
+        return false;
+    }
+
+    // The same fixed point as in FastDomTree, predecessors from outside of the region are unreachable
+    std::vector<size_t> idoms(rpo.size(), UNDEF_IDX);
+    idoms[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < rpo.size(); ++i) {
+            size_t new_idom = UNDEF_IDX;
+            for (auto *pred: rpo[i]->GetPreds()) {
+                auto it = rpo_idx.find(pred);
+                if (it == rpo_idx.end() || idoms[it->second] == UNDEF_IDX) {
+                    continue;
+                }
+                new_idom = new_idom == UNDEF_IDX ? it->second : Intersect(idoms, it->second, new_idom);
+            }
+            if (new_idom != idoms[i]) {
+                idoms[i] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    auto *root_idom = region_root->GetImmDom();
+    for (auto *bb: rpo) {
+        bb->ClearDomInfo();
+    }
+    region_root->SetImmDom(root_idom);
+    for (size_t i = 1; i < rpo.size(); ++i) {
+        assert(idoms[i] != UNDEF_IDX);
+        rpo[i]->SetImmDom(rpo[idoms[i]]);
+        rpo[idoms[i]]->AddDomChild(rpo[i]);
+    }
+    NumberDomTree();
+    return true;
+}
+
+size_t DomTree::Intersect(const std::vector<size_t> &idoms, size_t lhs, size_t rhs) {
+    while (lhs != rhs) {
+        while (lhs > rhs) {
+            lhs = idoms[lhs];
+        }
+        while (rhs > lhs) {
+            rhs = idoms[rhs];
+        }
+    }
+    return lhs;
 }
 
 }  // namespace compiler::passes
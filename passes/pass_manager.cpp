@@ -0,0 +1,125 @@
+#include <map>
+#include <sstream>
+
+#include "include/pass_manager.h"
+#include "include/analysis_manager.h"
+#include "include/check_elimination.h"
+#include "include/inlining.h"
+#include "include/loop_simplify.h"
+
+namespace compiler::passes {
+
+namespace {
+
+using PassFactory = std::unique_ptr<Pass> (*)(Graph *graph);
+
+template<class PassT>
+std::unique_ptr<Pass> CreatePass(Graph *graph) {
+    return std::make_unique<PassT>(graph);
+}
+
+const std::map<std::string, PassFactory> &GetPassFactories() {
+    static const std::map<std::string, PassFactory> factories{
+        {"check-elim", CreatePass<CheckElimination>},
+        {"dom-frontier", CreatePass<DominanceFrontier>},
+        {"dom-tree", [](Graph *graph) -> std::unique_ptr<Pass> { return std::make_unique<DomTree>(graph, false); }},
+        {"inline", [](Graph *graph) -> std::unique_ptr<Pass> {
+            return std::make_unique<Inlining>(graph, graph->GetAllocator());
+        }},
+        {"loop-analysis", CreatePass<LoopAnalyzer>},
+        {"loop-simplify", CreatePass<LoopSimplify>},
+        {"post-dom-tree", CreatePass<PostDomTree>},
+    };
+    return factories;
+}
+
+}  // namespace
+
+bool PassManager::AddPipeline(const std::string &pipeline) {
+    std::vector<std::pair<std::string, std::unique_ptr<Pass>>> new_passes;
+    std::istringstream names{pipeline};
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        name.erase(0, name.find_first_not_of(' '));
+        name.erase(name.find_last_not_of(' ') + 1);
+        auto it = GetPassFactories().find(name);
+        if (it == GetPassFactories().end()) {
+            std::cerr << "Error! Unknown pass \"" << name << "\" in the pipeline \"" << pipeline << "\"\n";
+            return false;
+        }
+        new_passes.emplace_back(name, it->second(graph_));
+    }
+    for (auto &pass: new_passes) {
+        passes_.push_back(std::move(pass));
+    }
+    return true;
+}
+
+void PassManager::AddPass(std::string name, std::unique_ptr<Pass> pass) {
+    passes_.emplace_back(std::move(name), std::move(pass));
+}
+
+std::vector<std::string> PassManager::GetPassNames() {
+    std::vector<std::string> names;
+    for (const auto &factory: GetPassFactories()) {
+        names.push_back(factory.first);
+    }
+    return names;
+}
+
+// IR is measured outside of the timed run, so the walk of the CFG made here is reused by the pass
+bool PassManager::Run() {
+    auto &analyses = graph_->GetAnalyses();
+    auto *allocator = graph_->GetAllocator();
+    for (auto &[name, pass]: passes_) {
+        PassStats stats;
+        stats.name = name;
+        stats.size_before = MeasureIr();
+        auto alloc_before = allocator->TakeSnapshot();
+        auto start = std::chrono::steady_clock::now();
+        stats.is_succeeded = analyses.RunPass(pass.get());
+        stats.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        stats.alloc_delta = (allocator->TakeSnapshot() - alloc_before).total;
+        stats.size_after = MeasureIr();
+        stats_.push_back(std::move(stats));
+        if (!stats_.back().is_succeeded) {
+            std::cerr << "Error! Pass " << name << " failed\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+IrSize PassManager::MeasureIr() {
+    IrSize size;
+    for (auto *bb: graph_->GetAnalyses().GetRpo()) {
+        ++size.blocks_num;
+        for ([[maybe_unused]] auto *instr: bb->GetInstrs()) {
+            ++size.instrs_num;
+        }
+    }
+    return size;
+}
+
+std::string PassManager::GetReport() const {
+    std::ostringstream report;
+    report << "[";
+    for (size_t i = 0; i < stats_.size(); ++i) {
+        const auto &stats = stats_[i];
+        report << (i == 0 ? "\n" : ",\n")
+               << "  {\"name\": \"" << stats.name << "\", "
+               << "\"succeeded\": " << (stats.is_succeeded ? "true" : "false") << ", "
+               << "\"time_ns\": " << stats.time.count() << ", "
+               << "\"alloc_objects\": " << stats.alloc_delta.objects_num << ", "
+               << "\"alloc_bytes_used\": " << stats.alloc_delta.bytes_used << ", "
+               << "\"alloc_bytes_reserved\": " << stats.alloc_delta.bytes_reserved << ", "
+               << "\"blocks_before\": " << stats.size_before.blocks_num << ", "
+               << "\"blocks_after\": " << stats.size_after.blocks_num << ", "
+               << "\"instrs_before\": " << stats.size_before.instrs_num << ", "
+               << "\"instrs_after\": " << stats.size_after.instrs_num << "}";
+    }
+    report << (stats_.empty() ? "]" : "\n]");
+    return report.str();
+}
+
+}  // namespace compiler::passes
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <numeric>
+
+#include "include/post_dom_tree.h"
+
+namespace compiler::passes {
+
+bool PostDomTree::Run() {
+    if (graph_->GetRoot() == nullptr) {
+        std::cerr << "Error! Post-dominator tree can't be built for the graph without root\n";
+        return false;
+    }
+    Reset();
+    WalkReversedCfg(Traversal{graph_}.getRPO());
+    CalcImmPostDoms();
+    NumberTree();
+    return true;
+}
+
+void PostDomTree::Reset() {
+    vertices_.clear();
+    parents_.clear();
+    numbers_.clear();
+    exit_children_.clear();
+}
+
+void PostDomTree::WalkReversedCfg(const BlocksVector &rpo) {
+    // blocks unreachable from the root don't take part, their ids might be stale
+    std::vector<bool> is_reachable(graph_->GetBlockIdsNum());
+    BlocksVector exits;
+    for (auto *bb: rpo) {
+        is_reachable[bb->GetId()] = true;
+        if (bb->GetSuccs().empty()) {
+            exits.push_back(bb);
+        }
+    }
+    numbers_.assign(graph_->GetBlockIdsNum(), UNDEF_NUM);
+    auto discover = [this, &is_reachable](BasicBlock *bb, size_t parent) {
+        if (!bb->HasId() || bb->GetId() >= is_reachable.size() || !is_reachable[bb->GetId()] ||
+            numbers_[bb->GetId()] != UNDEF_NUM) {
+            return false;
+        }
+        numbers_[bb->GetId()] = vertices_.size();
+        vertices_.push_back(bb);
+        parents_.push_back(parent);
+        return true;
+    };
+
+    vertices_.push_back(nullptr);
+    parents_.push_back(EXIT_NUM);
+    // predecessors are successors in the reversed CFG, the virtual exit precedes all the exits
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.emplace_back(EXIT_NUM, 0);
+    while (!stack.empty()) {
+        auto &[num, child_idx] = stack.back();
+        Span<BasicBlock *> children = num == EXIT_NUM ? Span<BasicBlock *>(exits) : vertices_[num]->GetPreds();
+        if (child_idx < children.size()) {
+            BasicBlock *child = children[child_idx++];
+            if (discover(child, num)) {
+                stack.emplace_back(vertices_.size() - 1, 0);
+            }
+            continue;
+        }
+        stack.pop_back();
+    }
+}
+
+/**
+ *  Semi-NCA (Georgiadis, Tarjan "Finding Dominators in Practice"): semidominators are computed by the link-eval
+ *  forest in reverse preorder, then the immediate dominator of every vertex is the nearest common ancestor of
+ *  its parent and its semidominator, which is found by climbing the already computed part of the tree.
+ */
+void PostDomTree::CalcImmPostDoms() {
+    size_t vertices_num = vertices_.size();
+    ancestors_ = parents_;
+    idoms_ = parents_;
+    semis_.resize(vertices_num);
+    std::iota(semis_.begin(), semis_.end(), 0);
+    labels_ = semis_;
+
+    for (size_t i = vertices_num - 1; i >= 1; --i) {
+        semis_[i] = parents_[i];
+        auto update_semi = [this, i](size_t pred_num) {
+            semis_[i] = std::min(semis_[i], semis_[Eval(pred_num, i + 1)]);
+        };
+        // successors are predecessors in the reversed CFG
+        auto *bb = vertices_[i];
+        if (bb->GetSuccs().empty()) {
+            update_semi(EXIT_NUM);
+        }
+        for (auto *succ: bb->GetSuccs()) {
+            size_t succ_num = GetNumber(succ);
+            if (succ_num != UNDEF_NUM) {
+                update_semi(succ_num);
+            }
+        }
+    }
+    for (size_t i = 1; i < vertices_num; ++i) {
+        size_t candidate = idoms_[i];
+        while (candidate > semis_[i]) {
+            candidate = idoms_[candidate];
+        }
+        idoms_[i] = candidate;
+    }
+}
+
+size_t PostDomTree::Eval(size_t vertex, size_t last_linked) {
+    if (ancestors_[vertex] < last_linked) {
+        return labels_[vertex];
+    }
+    // all the ancestors except the root of the linked tree
+    eval_stack_.clear();
+    do {
+        eval_stack_.push_back(vertex);
+        vertex = ancestors_[vertex];
+    } while (ancestors_[vertex] >= last_linked);
+
+    size_t prev = vertex;
+    size_t prev_label = labels_[prev];
+    do {
+        vertex = eval_stack_.back();
+        eval_stack_.pop_back();
+        ancestors_[vertex] = ancestors_[prev];
+        if (semis_[prev_label] < semis_[labels_[vertex]]) {
+            labels_[vertex] = labels_[prev];
+        } else {
+            prev_label = labels_[vertex];
+        }
+        prev = vertex;
+    } while (!eval_stack_.empty());
+    return labels_[vertex];
+}
+
+void PostDomTree::NumberTree() {
+    size_t vertices_num = vertices_.size();
+    std::vector<std::vector<size_t>> children(vertices_num);
+    for (size_t i = 1; i < vertices_num; ++i) {
+        children[idoms_[i]].push_back(i);
+        if (idoms_[i] == EXIT_NUM) {
+            exit_children_.push_back(vertices_[i]);
+        }
+    }
+    tree_pre_.assign(vertices_num, 0);
+    tree_post_.assign(vertices_num, 0);
+    uint32_t counter = 0;
+    std::vector<std::pair<size_t, size_t>> stack;
+    stack.emplace_back(EXIT_NUM, 0);
+    tree_pre_[EXIT_NUM] = ++counter;
+    while (!stack.empty()) {
+        auto &[num, child_idx] = stack.back();
+        if (child_idx < children[num].size()) {
+            size_t child = children[num][child_idx++];
+            tree_pre_[child] = ++counter;
+            stack.emplace_back(child, 0);
+            continue;
+        }
+        tree_post_[num] = ++counter;
+        stack.pop_back();
+    }
+}
+
+size_t PostDomTree::GetNumber(BasicBlock *bb) const {
+    return bb->HasId() && bb->GetId() < numbers_.size() ? numbers_[bb->GetId()] : UNDEF_NUM;
+}
+
+BasicBlock *PostDomTree::GetImmPostDom(BasicBlock *bb) const {
+    size_t num = GetNumber(bb);
+    return num == UNDEF_NUM ? nullptr : vertices_[idoms_[num]];
+}
+
+bool PostDomTree::IsInTree(BasicBlock *bb) const {
+    return GetNumber(bb) != UNDEF_NUM;
+}
+
+bool PostDomTree::IsPostDominatedBy(BasicBlock *bb, BasicBlock *pdom) const {
+    size_t num = GetNumber(bb);
+    size_t pdom_num = GetNumber(pdom);
+    if (num == UNDEF_NUM || pdom_num == UNDEF_NUM) {
+        return false;
+    }
+    return tree_pre_[pdom_num] <= tree_pre_[num] && tree_post_[num] <= tree_post_[pdom_num];
+}
+
+}  // namespace compiler::passes
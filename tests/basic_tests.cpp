@@ -1,130 +1,487 @@
-#include <gtest/gtest.h>
-
-#include "graph.h"
-#include "pass.h"
-#include "instruction.h"
-
-namespace compiler::test {
-
-TEST(basic_tests, example) {
-    /*
-    u64 fact (u32 a0):
-        // constants and parameters are in bb_start block
-        movi.u64 v0, 1          ┌
-        movi.u64 v1, 2          |  bb0
-        u32tou64 v2, a0         └
-    loop:                       ┌
-        cmp.u64 v1, v2          |  bb1
-        ja done                 └
-        mul.u64 v0, v0, v1      ┌
-        addi.u64 v1, v1, 1      |  bb2
-        jmp loop                └
-    done:                       ┌  bb3
-        ret.u64 v0              └
-     */
-
-    constexpr auto acc = InstrArg::Type::acc;
-    constexpr auto a = InstrArg::Type::a;
-    constexpr auto v = InstrArg::Type::v;
-    constexpr auto imm = InstrArg::Type::imm;
-    constexpr auto id = InstrArg::Type::id;
-    constexpr auto U64 = InstrType::U64;
-
-    Allocator alloc;
-
-    // Creating Graph
-    ZeroInputInstr *param0 = ZeroInputInstr::Create(&alloc, Opcode::PARAMETER, U64, {a, 0});
-    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
-    ZeroInputInstr *const2 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 2});
-    BasicBlock bb_start = BasicBlock::MakeBasicBlock({param0, const1, const2});
-
-    TwoInputInstr *addi = TwoInputInstr::Create(&alloc, Opcode::ADDI, U64, {v, 1}, {v, 1}, {imm, 1, const1});
-    TwoInputInstr *mul = TwoInputInstr::Create(&alloc, Opcode::MUL, U64, {v, 0}, {v, 0}, {v, 1});
-    ZeroInputInstr *ret = ZeroInputInstr::Create(&alloc, Opcode::RET, U64, {v, 0});  // done label
-
-    OneInputInstr *movi1 = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
-    OneInputInstr *movi2 = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 1}, {imm, 2, const2});
-    OneInputInstr *u32tou64 = OneInputInstr::Create(&alloc, Opcode::CAST, U64, {v, 2}, {a, 0, param0});
-    BasicBlock bb0 = BasicBlock::MakeBasicBlock({movi1, movi2, u32tou64});
-
-    DynamicInputInstr *phi1 = DynamicInputInstr::Create(&alloc, Opcode::PHI, U64, InstrArg{v, 1, addi},
-                                                        InstrArg{v, 1, movi1});
-    TwoInputInstr *cmp = TwoInputInstr::Create(&alloc, Opcode::CMP, U64, {/* acc */}, {v, 1, phi1},
-                                               {v, 2, u32tou64});  // loop label
-    OneInputInstr *ja = OneInputInstr::Create(&alloc, Opcode::JA, U64, {id, 9, ret},
-                                              {/* acc */});  // id = 9 ("done" label)
-    BasicBlock bb1 = BasicBlock::MakeBasicBlock({phi1, cmp, ja});
-
-    DynamicInputInstr *phi2 = DynamicInputInstr::Create(&alloc, Opcode::PHI, U64, {/* acc */}, InstrArg{v, 0, mul},
-                                                        InstrArg{v, 0, movi1});
-    ZeroInputInstr *jmp = ZeroInputInstr::Create(&alloc, Opcode::JMP, U64, {id, 4, cmp});  // id = 4 ("loop" label)
-    BasicBlock bb2 = BasicBlock::MakeBasicBlock({phi2, mul, addi, jmp});
-
-    BasicBlock bb3 = BasicBlock::MakeBasicBlock({ret});
-
-    BasicBlock bb_end = BasicBlock::MakeBasicBlock({});
-
-    // Phi funcs
-    phi1->AddUsers({cmp, addi});
-
-    phi2->AddUsers({mul, ret});
-
-    // Blocks CFG
-    BasicBlock::AddEdge(&bb_start, &bb0);
-
-    BasicBlock::AddEdge(&bb0, &bb1);
-
-    BasicBlock::AddEdge(&bb1, &bb2);
-    BasicBlock::AddEdge(&bb1, &bb3);
-
-    BasicBlock::AddEdge(&bb2, &bb1);
-
-    BasicBlock::AddEdge(&bb3, &bb_end);
-
-    Graph graph{&alloc, &bb_start, &bb_end, 1};
-    graph.SetGraphForBasicBlocks({&bb_start, &bb0, &bb1, &bb2, &bb3, &bb_end});
-
-    // Testing
-
-    ASSERT_EQ(movi1->GetPrev(), nullptr);
-    ASSERT_EQ(movi1->GetNext(), movi2);
-    ASSERT_EQ(movi2->GetPrev(), movi1);
-    ASSERT_EQ(movi2->GetNext(), u32tou64);
-    ASSERT_EQ(u32tou64->GetPrev(), movi2);
-    ASSERT_EQ(u32tou64->GetNext(), nullptr);
-    ASSERT_EQ(phi1->GetPrev(), nullptr);
-    ASSERT_EQ(cmp->GetPrev(), phi1);
-    ASSERT_EQ(cmp->GetNext(), ja);
-    ASSERT_EQ(ja->GetPrev(), cmp);
-    ASSERT_EQ(ja->GetNext(), nullptr);
-    ASSERT_EQ(phi2->GetPrev(), nullptr);
-    ASSERT_EQ(mul->GetPrev(), phi2);
-    ASSERT_EQ(mul->GetNext(), addi);
-    ASSERT_EQ(addi->GetPrev(), mul);
-    ASSERT_EQ(addi->GetNext(), jmp);
-    ASSERT_EQ(jmp->GetPrev(), addi);
-    ASSERT_EQ(jmp->GetNext(), nullptr);
-
-    ASSERT_TRUE(bb_start.GetPreds().empty());
-    ASSERT_EQ(bb_start.GetSuccs().size(), 1);
-    ASSERT_EQ(bb0.GetPreds().size(), 1);
-    ASSERT_EQ(bb0.GetSuccs().size(), 1);
-    ASSERT_EQ(bb1.GetPreds().size(), 2);
-    ASSERT_EQ(bb1.GetSuccs().size(), 2);
-    ASSERT_EQ(bb2.GetPreds().size(), 1);
-    ASSERT_EQ(bb2.GetSuccs().size(), 1);
-    ASSERT_EQ(bb3.GetPreds().size(), 1);
-    ASSERT_EQ(bb3.GetSuccs().size(), 1);
-    ASSERT_EQ(bb_end.GetPreds().size(), 1);
-    ASSERT_TRUE(bb_end.GetSuccs().empty());
-
-    ASSERT_EQ(graph.GetRoot(), &bb_start);
-    ASSERT_EQ(graph.GetEnd(), &bb_end);
-}
-
-}  // namespace compiler::test
-
-int main(int argc, char **argv) {
-    testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
-}
+#include <gtest/gtest.h>
+
+#include "graph.h"
+#include "pass.h"
+#include "instruction.h"
+
+namespace compiler::test {
+
+TEST(basic_tests, example) {
+    /*
+    u64 fact (u32 a0):
+        // constants and parameters are in bb_start block
+        movi.u64 v0, 1          ┌
+        movi.u64 v1, 2          |  bb0
+        u32tou64 v2, a0         └
+    loop:                       ┌
+        cmp.u64 v1, v2          |  bb1
+        ja done                 └
+        mul.u64 v0, v0, v1      ┌
+        addi.u64 v1, v1, 1      |  bb2
+        jmp loop                └
+    done:                       ┌  bb3
+        ret.u64 v0              └
+     */
+
+    [[maybe_unused]] constexpr auto acc = InstrArg::Type::acc;
+    constexpr auto a = InstrArg::Type::a;
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto id = InstrArg::Type::id;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+
+    // Creating Graph
+    ZeroInputInstr *param0 = ZeroInputInstr::Create(&alloc, Opcode::PARAMETER, U64, {a, 0});
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    ZeroInputInstr *const2 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 2});
+    BasicBlock bb_start = BasicBlock::MakeBasicBlock({param0, const1, const2});
+
+    TwoInputInstr *addi = TwoInputInstr::Create(&alloc, Opcode::ADDI, U64, {v, 1}, {v, 1}, {imm, 1, const1});
+    TwoInputInstr *mul = TwoInputInstr::Create(&alloc, Opcode::MUL, U64, {v, 0}, {v, 0}, {v, 1});
+    ZeroInputInstr *ret = ZeroInputInstr::Create(&alloc, Opcode::RET, U64, {v, 0});  // done label
+
+    OneInputInstr *movi1 = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    OneInputInstr *movi2 = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 1}, {imm, 2, const2});
+    OneInputInstr *u32tou64 = OneInputInstr::Create(&alloc, Opcode::CAST, U64, {v, 2}, {a, 0, param0});
+    BasicBlock bb0 = BasicBlock::MakeBasicBlock({movi1, movi2, u32tou64});
+
+    DynamicInputInstr *phi1 = DynamicInputInstr::Create(&alloc, Opcode::PHI, U64, InstrArg{v, 1, addi},
+                                                        InstrArg{v, 1, movi1});
+    TwoInputInstr *cmp = TwoInputInstr::Create(&alloc, Opcode::CMP, U64, {/* acc */}, {v, 1, phi1},
+                                               {v, 2, u32tou64});  // loop label
+    OneInputInstr *ja = OneInputInstr::Create(&alloc, Opcode::JA, U64, {id, 9, ret},
+                                              {/* acc */});  // id = 9 ("done" label)
+    BasicBlock bb1 = BasicBlock::MakeBasicBlock({phi1, cmp, ja});
+
+    DynamicInputInstr *phi2 = DynamicInputInstr::Create(&alloc, Opcode::PHI, U64, {/* acc */}, InstrArg{v, 0, mul},
+                                                        InstrArg{v, 0, movi1});
+    ZeroInputInstr *jmp = ZeroInputInstr::Create(&alloc, Opcode::JMP, U64, {id, 4, cmp});  // id = 4 ("loop" label)
+    BasicBlock bb2 = BasicBlock::MakeBasicBlock({phi2, mul, addi, jmp});
+
+    BasicBlock bb3 = BasicBlock::MakeBasicBlock({ret});
+
+    BasicBlock bb_end = BasicBlock::MakeBasicBlock({});
+
+    // Phi funcs
+    phi1->AddUsers({cmp, addi});
+
+    phi2->AddUsers({mul, ret});
+
+    // Blocks CFG
+    BasicBlock::AddEdge(&bb_start, &bb0);
+
+    BasicBlock::AddEdge(&bb0, &bb1);
+
+    BasicBlock::AddEdge(&bb1, &bb2);
+    BasicBlock::AddEdge(&bb1, &bb3);
+
+    BasicBlock::AddEdge(&bb2, &bb1);
+
+    BasicBlock::AddEdge(&bb3, &bb_end);
+
+    Graph graph{&alloc, &bb_start, &bb_end, 1};
+    graph.SetGraphForBasicBlocks({&bb_start, &bb0, &bb1, &bb2, &bb3, &bb_end});
+
+    // Testing
+
+    ASSERT_EQ(movi1->GetPrev(), nullptr);
+    ASSERT_EQ(movi1->GetNext(), movi2);
+    ASSERT_EQ(movi2->GetPrev(), movi1);
+    ASSERT_EQ(movi2->GetNext(), u32tou64);
+    ASSERT_EQ(u32tou64->GetPrev(), movi2);
+    ASSERT_EQ(u32tou64->GetNext(), nullptr);
+    ASSERT_EQ(phi1->GetPrev(), nullptr);
+    ASSERT_EQ(cmp->GetPrev(), phi1);
+    ASSERT_EQ(cmp->GetNext(), ja);
+    ASSERT_EQ(ja->GetPrev(), cmp);
+    ASSERT_EQ(ja->GetNext(), nullptr);
+    ASSERT_EQ(phi2->GetPrev(), nullptr);
+    ASSERT_EQ(mul->GetPrev(), phi2);
+    ASSERT_EQ(mul->GetNext(), addi);
+    ASSERT_EQ(addi->GetPrev(), mul);
+    ASSERT_EQ(addi->GetNext(), jmp);
+    ASSERT_EQ(jmp->GetPrev(), addi);
+    ASSERT_EQ(jmp->GetNext(), nullptr);
+
+    ASSERT_TRUE(bb_start.GetPreds().empty());
+    ASSERT_EQ(bb_start.GetSuccs().size(), 1);
+    ASSERT_EQ(bb0.GetPreds().size(), 1);
+    ASSERT_EQ(bb0.GetSuccs().size(), 1);
+    ASSERT_EQ(bb1.GetPreds().size(), 2);
+    ASSERT_EQ(bb1.GetSuccs().size(), 2);
+    ASSERT_EQ(bb2.GetPreds().size(), 1);
+    ASSERT_EQ(bb2.GetSuccs().size(), 1);
+    ASSERT_EQ(bb3.GetPreds().size(), 1);
+    ASSERT_EQ(bb3.GetSuccs().size(), 1);
+    ASSERT_EQ(bb_end.GetPreds().size(), 1);
+    ASSERT_TRUE(bb_end.GetSuccs().empty());
+
+    ASSERT_EQ(graph.GetRoot(), &bb_start);
+    ASSERT_EQ(graph.GetEnd(), &bb_end);
+
+    graph.BuildHandles();
+    ASSERT_EQ(graph.GetBlockHandlesNum(), 6);
+    ASSERT_EQ(graph.GetInstrHandlesNum(), 14);
+    ASSERT_EQ(graph.GetBlock(graph.GetHandle(&bb2)), &bb2);
+    ASSERT_EQ(graph.GetInstr(graph.GetHandle(mul)), mul);
+    ASSERT_EQ(graph.GetInstr(mul->GetHandle())->GetNext(), addi);
+
+    // Instructions are numbered densely by the graph they are added to
+    ASSERT_EQ(graph.GetInstrIdsNum(), 14);
+    for (size_t id = 0; id < graph.GetInstrIdsNum(); ++id) {
+        ASSERT_EQ(graph.FindInstr(id)->GetId(), id);
+    }
+    ASSERT_EQ(graph.FindInstr(mul->GetId()), mul);
+    ASSERT_EQ(graph.FindInstr(graph.GetInstrIdsNum()), nullptr);
+}
+
+TEST(basic_tests, allocator_pointers_stability) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+    constexpr size_t instrs_num = 5000;  // much more than a single slab
+
+    Allocator alloc;
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    std::vector<TwoInputInstr *> instrs;
+    InstructionBase *prev = const1;
+    for (size_t i = 0; i < instrs_num; ++i) {
+        auto *add = TwoInputInstr::Create(&alloc, Opcode::ADD, U64, {v, 0}, {v, 0, prev}, {imm, 1, const1});
+        instrs.push_back(add);
+        prev = add;
+    }
+
+    // All the previously returned pointers must be still valid
+    ASSERT_EQ(const1->GetOpcode(), Opcode::CONSTANT);
+    ASSERT_EQ(const1->GetDst()->num(), 1);
+    ASSERT_EQ(instrs.front()->GetInputs().at(0)->def(), const1);
+    for (size_t i = 1; i < instrs_num; ++i) {
+        ASSERT_EQ(instrs.at(i)->GetOpcode(), Opcode::ADD);
+        ASSERT_EQ(instrs.at(i)->GetInputs().at(0)->def(), instrs.at(i - 1));
+        ASSERT_EQ(instrs.at(i)->GetInputs().at(1)->def(), const1);
+    }
+}
+
+TEST(basic_tests, allocator_id_lookup) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    OneInputInstr *movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    TwoInputInstr *add = TwoInputInstr::Create(&alloc, Opcode::ADD, U64, {v, 1}, {v, 0, movi}, {imm, 1, const1});
+
+    ASSERT_EQ(alloc.GetById<ZeroInputInstr>(const1->GetId()), const1);
+    ASSERT_EQ(alloc.GetById<OneInputInstr>(movi->GetId()), movi);
+    ASSERT_EQ(alloc.GetById<TwoInputInstr>(add->GetId()), add);
+    ASSERT_EQ(alloc.GetById<TwoInputInstr>(movi->GetId()), nullptr);
+
+    ASSERT_EQ(alloc.GetByIdAmong<InstructionBase>(const1->GetId()), const1);
+    ASSERT_EQ(alloc.GetByIdAmong<InstructionBase>(movi->GetId()), movi);
+    ASSERT_EQ(alloc.GetByIdAmong<InstructionBase>(add->GetId()), add);
+    ASSERT_EQ(alloc.GetByIdAmong<InstructionBase>(add->GetId() + 1), nullptr);
+}
+
+TEST(basic_tests, detached_instruction_ids) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    OneInputInstr *movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    ASSERT_GE(const1->GetId(), DETACHED_INSTR_ID_BASE);
+    ASSERT_NE(const1->GetId(), movi->GetId());
+
+    BasicBlock bb = BasicBlock::MakeBasicBlock({const1, movi});
+    Graph graph{&alloc};
+    bb.SetGraph(&graph);
+    ASSERT_EQ(const1->GetId(), 0);
+    ASSERT_EQ(movi->GetId(), 1);
+
+    // Another graph renumbers the moved instructions and the first one forgets them
+    Graph other{&alloc};
+    OneInputInstr *movi2 = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 1}, {imm, 2, const1});
+    BasicBlock other_bb = BasicBlock::MakeBasicBlock({movi2});
+    other_bb.SetGraph(&other);
+    bb.RemoveInstr(movi);
+    other_bb.InsertInstrAfter(movi2, movi);
+    ASSERT_EQ(movi->GetId(), 1);
+    ASSERT_EQ(other.FindInstr(1), movi);
+    ASSERT_EQ(graph.FindInstr(1), nullptr);  // the same id by chance, but the instruction is in another graph
+    bb.RemoveInstr(const1);
+    other_bb.InsertInstrBefore(movi2, const1);
+    ASSERT_EQ(const1->GetId(), 2);
+    ASSERT_EQ(graph.FindInstr(0), nullptr);
+}
+
+TEST(basic_tests, instructions_order) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+    constexpr size_t inserts_num = 50;  // enough to exhaust the gaps between the order numbers
+
+    Allocator alloc;
+    Graph graph{&alloc};
+    ZeroInputInstr *first = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    ZeroInputInstr *last = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 2});
+    BasicBlock bb = BasicBlock::MakeBasicBlock({first, last});
+    bb.SetGraph(&graph);
+    ASSERT_TRUE(last->IsNextTo(first));
+    ASSERT_FALSE(first->IsNextTo(last));
+
+    // Every new instruction is put right after the first one, so they go in the reverse order of creation
+    std::vector<InstructionBase *> created;
+    for (size_t i = 0; i < inserts_num; ++i) {
+        created.push_back(OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, first}));
+        bb.InsertInstrAfter(first, created.back());
+    }
+    bb.InsertInstrBefore(first, OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 1}, {imm, 0, last}));
+
+    InsnsVec instrs = bb.GetAllInstrs();
+    ASSERT_EQ(instrs.size(), inserts_num + 3);
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        for (size_t j = 0; j < instrs.size(); ++j) {
+            ASSERT_EQ(instrs.at(i)->IsNextTo(instrs.at(j)), i >= j);
+        }
+    }
+    ASSERT_TRUE(created.front()->IsNextTo(created.back()));
+
+    // Removal keeps the order of the rest instructions
+    bb.EraseInstr(created.at(inserts_num / 2));
+    ASSERT_TRUE(created.at(inserts_num / 2 - 1)->IsNextTo(created.at(inserts_num / 2 + 1)));
+    ASSERT_TRUE(last->IsNextTo(created.front()));
+    ASSERT_FALSE(first->IsNextTo(created.back()));
+}
+
+TEST(basic_tests, allocator_reset) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    OneInputInstr *movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    size_t movi_id = movi->GetId();
+
+    alloc.Reset();
+    ASSERT_EQ(alloc.GetById<OneInputInstr>(movi_id), nullptr);
+
+    // Memory of the dropped objects is reused
+    ZeroInputInstr *new_const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    OneInputInstr *new_movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, new_const1});
+    ASSERT_EQ(static_cast<void *>(new_const1), static_cast<void *>(const1));
+    ASSERT_EQ(static_cast<void *>(new_movi), static_cast<void *>(movi));
+    ASSERT_EQ(alloc.GetById<OneInputInstr>(new_movi->GetId()), new_movi);
+    ASSERT_EQ(new_const1->GetUsers().front(), new_movi);
+}
+
+TEST(basic_tests, instruction_recycling) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    OneInputInstr *movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    DynamicInputInstr *phi = DynamicInputInstr::Create(&alloc, Opcode::PHI, U64, InstrArg{v, 1},
+                                                       InstrArg{v, 0, movi}, InstrArg{imm, 1, const1});
+
+    InstructionBase::Delete(&alloc, phi);
+    ASSERT_EQ(alloc.GetFreeNum<DynamicInputInstr>(), 1);
+    ASSERT_EQ(alloc.GetFreeNum<Use>(), 2);
+    ASSERT_TRUE(movi->GetUsers().empty());
+
+    InstructionBase::Delete(&alloc, movi);  // its user slot is inline and is recycled with it
+    ASSERT_EQ(alloc.GetFreeNum<OneInputInstr>(), 1);
+    ASSERT_FALSE(const1->HasUsers());
+
+    // Free lists are used first
+    OneInputInstr *new_movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    ASSERT_EQ(static_cast<void *>(new_movi), static_cast<void *>(movi));
+    ASSERT_EQ(alloc.GetFreeNum<OneInputInstr>(), 0);
+    ASSERT_EQ(const1->GetUsers().front(), new_movi);
+}
+
+TEST(basic_tests, allocator_stats) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+    auto before = alloc.TakeSnapshot();
+    ASSERT_EQ(before.total.bytes_reserved, 0);
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    OneInputInstr *movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 1}, {imm, 1, const1});
+
+    auto stats = alloc.GetStats<OneInputInstr>();
+    ASSERT_EQ(stats.objects_num, 2);
+    ASSERT_EQ(stats.bytes_used, 2 * sizeof(OneInputInstr));
+    ASSERT_GE(stats.bytes_reserved, stats.bytes_used);
+
+    InstructionBase::Delete(&alloc, movi);
+    auto diff = alloc.TakeSnapshot() - before;
+    ASSERT_EQ(diff.Get<OneInputInstr>().objects_num, 1);
+    ASSERT_EQ(diff.Get<OneInputInstr>().peak_bytes_used, 2 * sizeof(OneInputInstr));
+    ASSERT_EQ(diff.Get<ZeroInputInstr>().objects_num, 1);
+    ASSERT_EQ(diff.total.objects_num, 2);
+
+    // Memory is kept by reset, the high-water mark too
+    int64_t reserved = alloc.TakeSnapshot().total.bytes_reserved;
+    alloc.Reset();
+    auto after_reset = alloc.TakeSnapshot();
+    ASSERT_EQ(after_reset.total.objects_num, 0);
+    ASSERT_EQ(after_reset.total.bytes_used, 0);
+    ASSERT_EQ(after_reset.total.bytes_reserved, reserved);
+    ASSERT_EQ(after_reset.Get<OneInputInstr>().peak_bytes_used, 2 * sizeof(OneInputInstr));
+}
+
+TEST(basic_tests, allocator_pool) {
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    AllocatorPool pool;
+    Allocator *first = nullptr;
+    void *const_mem = nullptr;
+    {
+        auto alloc = pool.Acquire();
+        first = alloc.Get();
+        const_mem = ZeroInputInstr::Create(alloc.Get(), Opcode::CONSTANT, U64, {imm, 1});
+        ASSERT_EQ(pool.GetIdleNum(), 0);
+    }
+    ASSERT_EQ(pool.GetIdleNum(), 1);
+    {
+        auto alloc = pool.Acquire();  // warm allocator is checked out again
+        ASSERT_EQ(alloc.Get(), first);
+        ASSERT_EQ(static_cast<void *>(ZeroInputInstr::Create(alloc.Get(), Opcode::CONSTANT, U64, {imm, 2})), const_mem);
+
+        auto other = pool.Acquire();
+        ASSERT_NE(other.Get(), first);
+    }
+    ASSERT_EQ(pool.GetIdleNum(), 2);
+}
+
+TEST(basic_tests, inline_instruction_args) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    OneInputInstr *movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    TwoInputInstr *add = TwoInputInstr::Create(&alloc, Opcode::ADD, U64, {v, 1}, {v, 0, movi}, {imm, 1, const1});
+
+    // dst and inputs are placed inside the instruction itself
+    auto is_inside = [](const void *instr, size_t instr_size, const InstrArg *arg) {
+        auto *begin = static_cast<const char *>(instr);
+        auto *ptr = reinterpret_cast<const char *>(arg);
+        return ptr >= begin && ptr + sizeof(InstrArg) <= begin + instr_size;
+    };
+    ASSERT_TRUE(is_inside(const1, sizeof(ZeroInputInstr), const1->GetDst()));
+    ASSERT_TRUE(is_inside(movi, sizeof(OneInputInstr), movi->GetDst()));
+    ASSERT_TRUE(is_inside(movi, sizeof(OneInputInstr), movi->GetInputs().at(0)));
+    ASSERT_TRUE(is_inside(add, sizeof(TwoInputInstr), add->GetDst()));
+    ASSERT_TRUE(is_inside(add, sizeof(TwoInputInstr), add->GetInputs().at(0)));
+    ASSERT_TRUE(is_inside(add, sizeof(TwoInputInstr), add->GetInputs().at(1)));
+
+    ASSERT_EQ(add->GetDst()->num(), 1);
+    ASSERT_EQ(add->GetInputs().at(0)->def(), movi);
+    ASSERT_EQ(add->GetInputs().at(1)->def(), const1);
+}
+
+TEST(basic_tests, use_list) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+
+    Allocator alloc;
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    ZeroInputInstr *const2 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 2});
+    OneInputInstr *movi = OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 0}, {imm, 1, const1});
+    TwoInputInstr *add = TwoInputInstr::Create(&alloc, Opcode::ADD, U64, {v, 1}, {v, 0, movi}, {imm, 1, const1});
+    DynamicInputInstr *phi = DynamicInputInstr::Create(&alloc, Opcode::PHI, U64, InstrArg{v, 2},
+                                                       InstrArg{v, 0, movi}, InstrArg{v, 1, add});
+
+    // Users are linked on creation
+    ASSERT_EQ(const1->GetUsers().ToVector(), (std::vector<InstructionBase *>{movi, add}));
+    ASSERT_EQ(movi->GetUsers().ToVector(), (std::vector<InstructionBase *>{add, phi}));
+    ASSERT_EQ(add->GetUsers().ToVector(), (std::vector<InstructionBase *>{phi}));
+    movi->AddUser(add);  // already linked
+    ASSERT_EQ(movi->GetUsers().size(), 2);
+
+    // RAUW moves all the uses at once
+    const1->ReplaceInputForUsers(const2);
+    ASSERT_FALSE(const1->HasUsers());
+    ASSERT_EQ(const2->GetUsers().ToVector(), (std::vector<InstructionBase *>{movi, add}));
+    ASSERT_EQ(add->GetInputs().at(1)->def(), const2);
+
+    movi->RemoveUser(phi);
+    ASSERT_EQ(movi->GetUsers().ToVector(), (std::vector<InstructionBase *>{add}));
+
+    // Nop'ed instruction is unlinked from both its users and its inputs
+    add->MakeNop();
+    ASSERT_FALSE(add->HasUsers());
+    ASSERT_TRUE(phi->GetInputs().size() == 1 && phi->GetInputs().at(0)->def() == movi);
+    ASSERT_TRUE(movi->GetUsers().empty());
+    ASSERT_EQ(const2->GetUsers().ToVector(), (std::vector<InstructionBase *>{movi}));
+}
+
+TEST(basic_tests, dynamic_inputs_storage) {
+    constexpr auto v = InstrArg::Type::v;
+    constexpr auto imm = InstrArg::Type::imm;
+    constexpr auto U64 = InstrType::U64;
+    constexpr size_t inputs_num = 100;  // enough for several reallocations of the inputs vector
+
+    Allocator alloc;
+
+    ZeroInputInstr *const1 = ZeroInputInstr::Create(&alloc, Opcode::CONSTANT, U64, {imm, 1});
+    DynamicInputInstr *phi = DynamicInputInstr::Create(&alloc, Opcode::PHI, U64, InstrArg{v, 0});
+    ASSERT_FALSE(phi->HasInputs());
+    ASSERT_TRUE(phi->HasDynamicInputs());
+
+    std::vector<InstructionBase *> defs;
+    for (size_t i = 0; i < inputs_num; ++i) {
+        defs.push_back(OneInputInstr::Create(&alloc, Opcode::MOVI, U64, {v, 1}, {imm, 1, const1}));
+        phi->AddInput(&alloc, InstrArg{v, 1, defs.back()});
+    }
+    ASSERT_TRUE(phi->HasDynamicInputs());
+    ASSERT_EQ(phi->GetInputsNum(), inputs_num);
+    for (size_t i = 0; i < inputs_num; ++i) {
+        ASSERT_EQ(phi->GetInput(i)->def(), defs.at(i));
+    }
+
+    InstructionBase *base = phi;
+    base->RemoveInput(defs.front());
+    ASSERT_EQ(base->GetInputs().size(), inputs_num - 1);
+    ASSERT_EQ(base->GetInputs().front()->def(), defs.at(1));
+    ASSERT_TRUE(defs.front()->GetUsers().empty());
+
+    base->RemoveInputs();
+    ASSERT_FALSE(base->HasInputs());
+    ASSERT_TRUE(defs.back()->GetUsers().empty());
+
+    // Fixed inputs keep the slots, removed input is nullptr
+    InstructionBase *movi = defs.front();
+    movi->RemoveInput(const1);
+    ASSERT_EQ(movi->GetInputsNum(), 1);
+    ASSERT_EQ(movi->GetInput(0), nullptr);
+    ASSERT_FALSE(movi->HasDynamicInputs());
+}
+
+}  // namespace compiler::test
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
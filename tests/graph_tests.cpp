@@ -3,6 +3,12 @@
 #include "graph.h"
 #include "pass.h"
 #include "loop_analyzer.h"
+#include "post_dom_tree.h"
+#include "dominance_frontier.h"
+#include "analysis_manager.h"
+#include "check_elimination.h"
+#include "loop_simplify.h"
+#include "pass_manager.h"
 
 namespace compiler::test {
 
@@ -346,6 +352,110 @@ TEST_F(GraphTest, Example3_Rpo) {
     ASSERT_EQ(rpo.at(8)->GetId(), I);
 }
 
+TEST_F(GraphTest, long_chain_rpo) {
+    constexpr size_t BLOCKS_NUM = 100000;
+    std::vector<BasicBlock> blocks(BLOCKS_NUM);
+    for (size_t i = 0; i + 1 < BLOCKS_NUM; ++i) {
+        BasicBlock::AddEdge(&blocks[i], &blocks[i + 1]);
+    }
+    Graph graph{GetAllocator(), &blocks.front(), &blocks.back(), 0};
+    for (auto &bb: blocks) {
+        bb.SetGraph(&graph);
+    }
+
+    passes::Traversal tr{&graph};
+    const auto &rpo = tr.getRPO();  // the walk is iterative, so the depth of CFG is not limited by the stack
+    ASSERT_EQ(rpo.size(), BLOCKS_NUM);
+    ASSERT_EQ(rpo.front(), &blocks.front());
+    ASSERT_EQ(rpo.back(), &blocks.back());
+
+    // The result is cached in the graph until the CFG is changed
+    ASSERT_TRUE(graph.IsRpoValid());
+    ASSERT_EQ(&passes::Traversal{&graph}.getRPO(), &rpo);
+    blocks[BLOCKS_NUM - 2].RemoveFromSuccs(blocks.back().GetId());
+    ASSERT_FALSE(graph.IsRpoValid());
+    ASSERT_EQ(tr.getRPO().size(), BLOCKS_NUM - 1);
+}
+
+TEST_F(GraphTest, Example1_Handles) {
+    Graph graph = GetFirstGraph();
+    ASSERT_FALSE(graph.HasHandles());
+    graph.BuildHandles();
+    ASSERT_TRUE(graph.HasHandles());
+
+    passes::Traversal tr{&graph};
+    const auto &rpo = tr.getRPO();
+    ASSERT_EQ(graph.GetBlockHandlesNum(), rpo.size());
+    for (size_t i = 0; i < rpo.size(); ++i) {
+        BlockHandle handle = graph.GetHandle(rpo.at(i));
+        ASSERT_TRUE(handle.IsValid());
+        ASSERT_EQ(handle.GetIndex(), i);  // handles are dense and follow RPO
+        ASSERT_EQ(graph.GetBlock(handle), rpo.at(i));
+    }
+
+    BasicBlock foreign_bb;
+    ASSERT_FALSE(graph.GetHandle(&foreign_bb).IsValid());
+    ASSERT_EQ(graph.GetBlock(BlockHandle{}), nullptr);
+    ASSERT_EQ(graph.GetBlock(BlockHandle{static_cast<uint32_t>(rpo.size())}), nullptr);
+}
+
+TEST_F(GraphTest, block_ids_compaction) {
+    /*
+     *               A
+     *             ↙   ↘
+     *           B       C
+     *             ↘   ↙
+     *               D
+     *
+     */
+    BasicBlock A, B, C, D;
+
+    BasicBlock::AddEdge(&A, &B);
+    BasicBlock::AddEdge(&A, &C);
+
+    BasicBlock::AddEdge(&B, &D);
+
+    BasicBlock::AddEdge(&C, &D);
+
+    Graph graph{GetAllocator(), &A, &D, 0};
+    graph.SetGraphForBasicBlocks({&A, &B, &C, &D});
+    ASSERT_EQ(graph.FindBlock(3), &C);  // ids are given by the lookup itself
+    ASSERT_EQ(graph.FindBlock(2), &B);
+    ASSERT_EQ(graph.FindBlock(4), nullptr);
+
+    // C becomes unreachable
+    A.RemoveFromSuccs(C.GetId());
+    D.RemoveFromPreds(C.GetId());
+    graph.CompactBlockIds();
+    ASSERT_EQ(graph.GetBlockIdsNum(), 3);
+    ASSERT_EQ(A.GetId(), 0);
+    ASSERT_EQ(D.GetId(), 1);
+    ASSERT_EQ(B.GetId(), 2);
+    ASSERT_EQ(graph.FindBlock(2), &B);
+    ASSERT_EQ(graph.FindBlock(3), nullptr);
+}
+
+TEST_F(GraphTest, markers) {
+    Graph graph = GetFirstGraph();
+    BasicBlock *A = graph.GetRoot();
+    BasicBlock *D = graph.GetEnd();
+    {
+        MarkerHolder first{&graph};
+        MarkerHolder second{&graph};
+        A->SetMarker(first.Get());
+        D->SetMarker(second.Get());
+        ASSERT_TRUE(A->IsMarked(first.Get()));
+        ASSERT_FALSE(A->IsMarked(second.Get()));  // markers don't clobber each other
+        ASSERT_TRUE(D->IsMarked(second.Get()));
+        D->ResetMarker(second.Get());
+        ASSERT_FALSE(D->IsMarked(second.Get()));
+    }
+    // The slot is reused, but the blocks aren't marked with the new marker
+    MarkerHolder third{&graph};
+    ASSERT_FALSE(A->IsMarked(third.Get()));
+    ASSERT_FALSE(D->IsMarked(third.Get()));
+}
+
 /*
  ====================================================
  ================== DomTree tests ===================
@@ -554,6 +664,300 @@ TEST_F(GraphTest, Example3_Dom_Tree) {
     }
 }
 
+// Fast dominator tree must give the same result as the slow one
+void CompareWithSlowDomTree(Graph graph) {
+    passes::DomTree slow{&graph, true};
+    ASSERT_TRUE(slow.Run());
+    passes::Traversal tr{&graph};
+    BlocksVector rpo = tr.getRPO();
+    std::vector<BasicBlock *> imm_doms;
+    std::vector<std::set<BasicBlock *>> doms;
+    for (auto *bb: rpo) {
+        imm_doms.push_back(bb->GetImmDom());
+        auto bb_doms = bb->GetDomBlocks();
+        doms.emplace_back(bb_doms.begin(), bb_doms.end());
+    }
+
+    passes::DomTree fast{&graph, false};
+    ASSERT_TRUE(fast.Run());
+    for (size_t i = 0; i < rpo.size(); ++i) {
+        SCOPED_TRACE(rpo[i]->GetId());
+        ASSERT_EQ(rpo[i]->GetImmDom(), imm_doms[i]);
+        auto bb_doms = rpo[i]->GetDomBlocks();
+        ASSERT_EQ(std::set<BasicBlock *>(bb_doms.begin(), bb_doms.end()), doms[i]);
+        for (auto *child: rpo[i]->GetDomChildren()) {
+            ASSERT_EQ(child->GetImmDom(), rpo[i]);
+        }
+        // constant time check agrees with the dominators sets
+        for (auto *other: rpo) {
+            bool is_dom = other == rpo[i] || doms[i].count(other) != 0;
+            ASSERT_EQ(rpo[i]->IsDominatedBy(other), is_dom);
+        }
+    }
+}
+
+TEST_F(GraphTest, Fast_Dom_Tree) {
+    CompareWithSlowDomTree(GetFirstGraph());
+    CompareWithSlowDomTree(GetSecondGraph());
+    CompareWithSlowDomTree(GetThirdGraph());
+}
+
+// Incrementally updated dominator tree must be the same as the rebuilt one
+void CompareWithRebuiltDomTree(Graph *graph) {
+    passes::Traversal tr{graph};
+    BlocksVector rpo = tr.getRPO();
+    std::vector<BasicBlock *> imm_doms;
+    std::vector<std::vector<bool>> is_dominated;
+    for (auto *bb: rpo) {
+        imm_doms.push_back(bb->GetImmDom());
+        is_dominated.emplace_back();
+        for (auto *other: rpo) {
+            is_dominated.back().push_back(bb->IsDominatedBy(other));
+        }
+    }
+
+    passes::DomTree dom_tree{graph, false};
+    ASSERT_TRUE(dom_tree.Run());
+    for (size_t i = 0; i < rpo.size(); ++i) {
+        SCOPED_TRACE(rpo[i]->GetId());
+        ASSERT_EQ(rpo[i]->GetImmDom(), imm_doms[i]);
+        for (size_t j = 0; j < rpo.size(); ++j) {
+            ASSERT_EQ(rpo[i]->IsDominatedBy(rpo[j]), is_dominated[i][j]);
+        }
+    }
+}
+
+TEST_F(GraphTest, Dom_Tree_Updates) {
+    using namespace G3_BB;
+    using Kind = passes::CfgUpdate::Kind;
+    Graph graph = GetThirdGraph();
+    // blocks are shared with the fixture graph, the copy must see the CFG edits
+    for (auto *block: passes::Traversal{&graph}.getRPO(true)) {
+        block->SetGraph(&graph);
+    }
+    passes::DomTree dom_tree{&graph, false};
+    ASSERT_TRUE(dom_tree.Run());
+    auto bb = [&graph](uint8_t id) {
+        return graph.FindBlock(id);
+    };
+    auto remove_edge = [](BasicBlock *from, BasicBlock *to) {
+        from->RemoveFromSuccs(to->GetId());
+        to->RemoveFromPreds(from->GetId());
+    };
+
+    // Edges inside the loops
+    BasicBlock::AddEdge(bb(F), bb(C));
+    BasicBlock::AddEdge(bb(E), bb(I));
+    remove_edge(bb(H), bb(G));
+    ASSERT_TRUE(dom_tree.ApplyUpdates({{Kind::INSERT, bb(F), bb(C)}, {Kind::INSERT, bb(E), bb(I)},
+                                       {Kind::REMOVE, bb(H), bb(G)}}, {}));
+    CompareWithRebuiltDomTree(&graph);
+
+    // C is entered only from the loop of E and F now
+    remove_edge(bb(B), bb(C));
+    ASSERT_TRUE(dom_tree.ApplyUpdates({{Kind::REMOVE, bb(B), bb(C)}}, {}));
+    CompareWithRebuiltDomTree(&graph);
+
+    // New block between A and B takes the whole tree
+    BasicBlock new_bb;
+    new_bb.SetGraph(&graph);
+    remove_edge(bb(A), bb(B));
+    BasicBlock::AddEdge(bb(A), &new_bb);
+    BasicBlock::AddEdge(&new_bb, bb(B));
+    ASSERT_TRUE(dom_tree.ApplyUpdates({{Kind::REMOVE, bb(A), bb(B)}, {Kind::INSERT, bb(A), &new_bb},
+                                       {Kind::INSERT, &new_bb, bb(B)}}, {&new_bb}));
+    ASSERT_EQ(bb(B)->GetImmDom(), &new_bb);
+    CompareWithRebuiltDomTree(&graph);
+
+    // H becomes unreachable, so the tree is rebuilt
+    remove_edge(bb(F), bb(H));
+    ASSERT_TRUE(dom_tree.ApplyUpdates({{Kind::REMOVE, bb(F), bb(H)}}, {}));
+    CompareWithRebuiltDomTree(&graph);
+}
+
+// nullptr means the virtual exit
+void TestImmPostDoms(Graph *graph, const passes::PostDomTree &pdom_tree,
+                     std::initializer_list<std::pair<uint8_t, std::optional<uint8_t>>> imm_pdoms) {
+    for (auto [id, imm_pdom_id]: imm_pdoms) {
+        SCOPED_TRACE(static_cast<int>(id));
+        auto *bb = graph->FindBlock(id);
+        ASSERT_TRUE(pdom_tree.IsInTree(bb));
+        auto *imm_pdom = pdom_tree.GetImmPostDom(bb);
+        if (!imm_pdom_id.has_value()) {
+            ASSERT_EQ(imm_pdom, nullptr);
+            continue;
+        }
+        ASSERT_EQ(imm_pdom, graph->FindBlock(imm_pdom_id.value()));
+        ASSERT_TRUE(pdom_tree.IsPostDominatedBy(bb, imm_pdom));
+        ASSERT_TRUE(pdom_tree.IsPostDominatedBy(bb, bb));
+        ASSERT_FALSE(pdom_tree.IsPostDominatedBy(imm_pdom, bb));
+    }
+}
+
+TEST_F(GraphTest, Post_Dom_Tree) {
+    {
+        using namespace G1_BB;
+        Graph graph = GetFirstGraph();
+        passes::PostDomTree pdom_tree{&graph};
+        ASSERT_TRUE(pdom_tree.Run());
+        TestImmPostDoms(&graph, pdom_tree, {{A, B}, {B, D}, {C, D}, {D, std::nullopt}, {E, D}, {F, D}, {G, D}});
+    }
+    {
+        using namespace G2_BB;
+        Graph graph = GetSecondGraph();
+        passes::PostDomTree pdom_tree{&graph};
+        ASSERT_TRUE(pdom_tree.Run());
+        TestImmPostDoms(&graph, pdom_tree, {{A, B}, {B, C}, {C, D}, {D, E}, {E, F}, {F, G}, {G, I}, {H, B},
+                                              {I, K}, {J, C}, {K, std::nullopt}});
+        ASSERT_TRUE(pdom_tree.IsPostDominatedBy(graph.FindBlock(A), graph.FindBlock(K)));
+        ASSERT_TRUE(pdom_tree.IsPostDominatedBy(graph.FindBlock(H), graph.FindBlock(I)));
+        ASSERT_FALSE(pdom_tree.IsPostDominatedBy(graph.FindBlock(B), graph.FindBlock(J)));
+    }
+    {
+        using namespace G3_BB;
+        Graph graph = GetThirdGraph();
+        passes::PostDomTree pdom_tree{&graph};
+        ASSERT_TRUE(pdom_tree.Run());
+        TestImmPostDoms(&graph, pdom_tree, {{A, B}, {B, I}, {C, D}, {D, G}, {E, I}, {F, I}, {G, I}, {H, I},
+                                              {I, std::nullopt}});
+    }
+}
+
+TEST_F(GraphTest, Post_Dom_Tree_Several_Exits) {
+    /*
+     *               A
+     *             ↙   ↘
+     *           B       C ←┐
+     *         ↙   ↘     ↓  |
+     *       D       E   F -┘
+     *
+     */
+    std::vector<BasicBlock> blocks(6);
+    BasicBlock &A = blocks[0], &B = blocks[1], &C = blocks[2], &D = blocks[3], &E = blocks[4], &F = blocks[5];
+    BasicBlock::AddEdge(&A, &B);
+    BasicBlock::AddEdge(&A, &C);
+    BasicBlock::AddEdge(&B, &D);
+    BasicBlock::AddEdge(&B, &E);
+    BasicBlock::AddEdge(&C, &F);
+    BasicBlock::AddEdge(&F, &C);
+    Graph graph{GetAllocator()};
+    graph.SetRoot(&A);
+    graph.SetEnd(&D);
+    graph.SetGraphForBasicBlocks({&A, &B, &C, &D, &E, &F});
+
+    passes::PostDomTree pdom_tree{&graph};
+    ASSERT_TRUE(pdom_tree.Run());
+    // infinite loop never reaches an exit, so A is post-dominated only by the virtual exit
+    ASSERT_FALSE(pdom_tree.IsInTree(&C));
+    ASSERT_FALSE(pdom_tree.IsInTree(&F));
+    ASSERT_EQ(pdom_tree.GetImmPostDom(&A), &B);
+    ASSERT_EQ(pdom_tree.GetImmPostDom(&B), nullptr);
+    ASSERT_EQ(pdom_tree.GetImmPostDom(&D), nullptr);
+    ASSERT_FALSE(pdom_tree.IsPostDominatedBy(&B, &D));
+    auto exit_children = pdom_tree.GetExitChildren();
+    ASSERT_EQ(std::set<BasicBlock *>(exit_children.begin(), exit_children.end()),
+              (std::set<BasicBlock *>{&B, &D, &E}));
+
+    // The second exit from A: B doesn't post-dominate A anymore
+    BasicBlock G;
+    BasicBlock::AddEdge(&A, &G);
+    G.SetGraph(&graph);
+    ASSERT_TRUE(pdom_tree.Run());
+    ASSERT_EQ(pdom_tree.GetImmPostDom(&A), nullptr);
+    ASSERT_EQ(pdom_tree.GetImmPostDom(&G), nullptr);
+}
+
+template<typename...Args>
+void TestFrontier(Graph *graph, const passes::DominanceFrontier &df, uint8_t id, Args...args) {
+    SCOPED_TRACE(static_cast<int>(id));
+    auto frontier = df.GetFrontier(graph->FindBlock(id));
+    ASSERT_EQ(std::set<BasicBlock *>(frontier.begin(), frontier.end()),
+              (std::set<BasicBlock *>{graph->FindBlock(args)...}));
+    ASSERT_EQ(frontier.size(), sizeof...(args));
+}
+
+TEST_F(GraphTest, Dominance_Frontier) {
+    {
+        using namespace G1_BB;
+        Graph graph = GetFirstGraph();
+        passes::DominanceFrontier df{&graph};
+        ASSERT_TRUE(df.Run());
+        TestFrontier(&graph, df, A);
+        TestFrontier(&graph, df, B);
+        TestFrontier(&graph, df, C, D);
+        TestFrontier(&graph, df, D);
+        TestFrontier(&graph, df, E, D);
+        TestFrontier(&graph, df, F, D);
+        TestFrontier(&graph, df, G, D);
+    }
+    {
+        using namespace G3_BB;
+        Graph graph = GetThirdGraph();
+        passes::DominanceFrontier df{&graph};
+        ASSERT_TRUE(df.Run());
+        TestFrontier(&graph, df, A);
+        TestFrontier(&graph, df, B, B);
+        TestFrontier(&graph, df, C, D);
+        TestFrontier(&graph, df, D, G);
+        TestFrontier(&graph, df, E, B, D, G, I);
+        TestFrontier(&graph, df, F, B, G, I);
+        TestFrontier(&graph, df, G, C, I);
+        TestFrontier(&graph, df, H, G, I);
+        TestFrontier(&graph, df, I);
+    }
+}
+
+TEST_F(GraphTest, Analysis_Manager) {
+    using namespace G3_BB;
+    Graph graph = GetThirdGraph();
+    // blocks are shared with the fixture graph, the copy must see the CFG edits
+    for (auto *block: passes::Traversal{&graph}.getRPO(true)) {
+        block->SetGraph(&graph);
+    }
+    auto &analyses = graph.GetAnalyses();
+
+    // Computed on the first request and reused after that
+    ASSERT_NE(analyses.GetDominanceFrontier(), nullptr);
+    ASSERT_NE(analyses.GetDominanceFrontier(), nullptr);
+    ASSERT_NE(analyses.GetPostDomTree(), nullptr);
+    ASSERT_TRUE(analyses.RequireDomTree());
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::DOM_TREE), 1);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::DOM_FRONTIER), 1);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::POST_DOM_TREE), 1);
+
+    // The pass doesn't change the CFG, so nothing is recomputed
+    passes::CheckElimination check_elimination{&graph};
+    ASSERT_TRUE(analyses.RunPass(&check_elimination));
+    ASSERT_NE(analyses.GetDominanceFrontier(), nullptr);
+    ASSERT_NE(analyses.GetPostDomTree(), nullptr);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::DOM_TREE), 1);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::DOM_FRONTIER), 1);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::POST_DOM_TREE), 1);
+
+    // Only the declared analysis survives, the frontiers follow the CFG
+    graph.InvalidateAnalyses(PreservedAnalyses::None().Preserve(Analysis::DOM_TREE));
+    ASSERT_TRUE(graph.IsDomTreeValid());
+    ASSERT_FALSE(graph.IsRpoValid());
+    ASSERT_FALSE(graph.IsAnalysisValid(Analysis::POST_DOM_TREE));
+    ASSERT_FALSE(graph.IsAnalysisValid(Analysis::DOM_FRONTIER));
+    ASSERT_NE(analyses.GetDominanceFrontier(), nullptr);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::DOM_TREE), 1);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::DOM_FRONTIER), 2);
+
+    // CFG edit drops the walks of the CFG, the dominator tree is maintained by the editing pass
+    BasicBlock::AddEdge(graph.FindBlock(E), graph.FindBlock(I));
+    ASSERT_FALSE(graph.IsRpoValid());
+    ASSERT_FALSE(graph.IsAnalysisValid(Analysis::DOM_FRONTIER));
+    ASSERT_TRUE(graph.IsDomTreeValid());
+    graph.InvalidateAnalyses(PreservedAnalyses::None());
+    ASSERT_FALSE(graph.IsDomTreeValid());
+
+    ASSERT_NE(analyses.GetRootLoop(), nullptr);
+    ASSERT_NE(analyses.GetRootLoop(), nullptr);
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::LOOP_INFO), 1);
+    ASSERT_EQ(graph.FindBlock(B)->GetLoop()->GetHeader(), graph.FindBlock(B));
+}
+
 /*
  =======================================================
  ================= LoopAnalyzer tests ==================
@@ -931,6 +1335,259 @@ TEST_F(GraphTest, Example_6_Loop_Analyzer) {
     }
 }
 
+TEST_F(GraphTest, Loop_Depth) {
+    using namespace G2_BB;
+    Graph graph = GetSecondGraph();
+    passes::LoopAnalyzer loopAnalyzer{&graph};
+    ASSERT_TRUE(loopAnalyzer.Run());
+
+    auto *loop_b = graph.FindBlock(B)->GetLoop();
+    auto *loop_c = graph.FindBlock(C)->GetLoop();
+    ASSERT_EQ(graph.GetRootLoop()->GetDepth(), 0);
+    ASSERT_EQ(loop_b->GetDepth(), 1);
+    ASSERT_EQ(loop_c->GetDepth(), 2);
+    ASSERT_EQ(graph.FindBlock(F)->GetLoopDepth(), 2);
+    ASSERT_EQ(graph.FindBlock(H)->GetLoopDepth(), 1);
+    ASSERT_EQ(graph.FindBlock(K)->GetLoopDepth(), 0);
+
+    // HasBlock is limited by the loop itself, Contains takes the inner loops into account
+    ASSERT_TRUE(loop_b->HasBlock(graph.FindBlock(J)));
+    ASSERT_FALSE(loop_b->HasBlock(graph.FindBlock(D)));
+    ASSERT_TRUE(loop_b->Contains(graph.FindBlock(D)));
+    ASSERT_TRUE(loop_b->Contains(graph.FindBlock(E)));
+    ASSERT_FALSE(loop_b->Contains(graph.FindBlock(I)));
+    ASSERT_FALSE(loop_c->Contains(graph.FindBlock(E)));
+    ASSERT_TRUE(graph.GetRootLoop()->Contains(graph.FindBlock(D)));
+}
+
+TEST_F(GraphTest, Deeply_Nested_Loops) {
+    /*
+     *  headers[0] → ... → headers[N-1] → latches[N-1] → ... → latches[0] → exit,
+     *  every latches[i] jumps back to headers[i], so the loop i is nested into the loop i - 1
+     */
+    constexpr size_t LOOPS_NUM = 5000;
+    std::vector<BasicBlock> headers(LOOPS_NUM);
+    std::vector<BasicBlock> latches(LOOPS_NUM);
+    BasicBlock entry, exit;
+    BasicBlock::AddEdge(&entry, &headers.front());
+    BasicBlock::AddEdge(&headers.back(), &latches.back());
+    for (size_t i = 0; i < LOOPS_NUM; ++i) {
+        if (i + 1 < LOOPS_NUM) {
+            BasicBlock::AddEdge(&headers[i], &headers[i + 1]);
+        }
+        BasicBlock::AddEdge(&latches[i], &headers[i]);
+        BasicBlock::AddEdge(&latches[i], i == 0 ? &exit : &latches[i - 1]);
+    }
+    Graph graph{GetAllocator(), &entry, &exit, 0};
+    entry.SetGraph(&graph);
+    exit.SetGraph(&graph);
+    for (size_t i = 0; i < LOOPS_NUM; ++i) {
+        headers[i].SetGraph(&graph);
+        latches[i].SetGraph(&graph);
+    }
+
+    // the walks are iterative, so the nesting isn't limited by the stack
+    ASSERT_TRUE((passes::DomTree{&graph, false}.Run()));
+    passes::LoopAnalyzer loopAnalyzer{&graph};
+    ASSERT_TRUE(loopAnalyzer.Run());
+    ASSERT_EQ(exit.GetLoopDepth(), 0);
+    for (size_t i = 0; i < LOOPS_NUM; ++i) {
+        auto *loop = headers[i].GetLoop();
+        ASSERT_EQ(loop->GetDepth(), i + 1);
+        ASSERT_EQ(loop->GetLoopBlocks().size(), 2);
+        ASSERT_TRUE(loop->HasBlock(&latches[i]));
+        ASSERT_EQ(loop->GetInLoops().size(), i + 1 < LOOPS_NUM ? 1 : 0);
+    }
+    ASSERT_TRUE(headers.front().GetLoop()->Contains(&latches.back()));
+    ASSERT_FALSE(headers.back().GetLoop()->Contains(&latches.front()));
+}
+
+TEST_F(GraphTest, Loop_Split_Block) {
+    /*
+     *      A
+     *      ↓
+     *  ┌-→ B
+     *  |   ↓
+     *  └-- C → D
+     */
+    constexpr auto imm = InstrArg::Type::imm;
+    auto *first = ZeroInputInstr::Create(GetAllocator(), Opcode::CONSTANT, InstrType::U64, {imm, 1});
+    auto *second = ZeroInputInstr::Create(GetAllocator(), Opcode::CONSTANT, InstrType::U64, {imm, 2});
+    BasicBlock A, B, D;
+    BasicBlock C = BasicBlock::MakeBasicBlock({first, second});
+    BasicBlock::AddEdge(&A, &B);
+    BasicBlock::AddEdge(&B, &C);
+    BasicBlock::AddEdge(&C, &B);
+    BasicBlock::AddEdge(&C, &D);
+    Graph graph{GetAllocator(), &A, &D, 0};
+    graph.SetGraphForBasicBlocks({&A, &B, &C, &D});
+
+    Loop *loop;
+    {
+        // loops are kept by the graph, so they outlive the analyzer
+        passes::LoopAnalyzer loopAnalyzer{&graph};
+        ASSERT_TRUE(loopAnalyzer.Run());
+        loop = B.GetLoop();
+    }
+    ASSERT_EQ(graph.GetLoopsNum(), 2);
+    ASSERT_EQ(loop->GetBackEdges().at(0), &C);
+
+    // The second part takes the back edge, the loop tree stays valid without rerunning the analysis
+    auto *second_bb = C.SplitOn(first);
+    ASSERT_TRUE(graph.IsLoopAnalysisValid());
+    ASSERT_EQ(second_bb->GetLoop(), loop);
+    ASSERT_EQ(second_bb->GetLoopDepth(), 1);
+    ASSERT_TRUE(loop->HasBlock(&C));
+    ASSERT_EQ(loop->GetLoopBlocks().size(), 3);
+    ASSERT_EQ(loop->GetBackEdges().size(), 1);
+    ASSERT_EQ(loop->GetBackEdges().at(0), second_bb);
+}
+
+TEST_F(GraphTest, Loop_Clone) {
+    using namespace G2_BB;
+    Graph graph = GetSecondGraph();
+    for (auto *block: passes::Traversal{&graph}.getRPO(true)) {
+        block->SetGraph(&graph);
+    }
+    ASSERT_TRUE(passes::LoopAnalyzer{&graph}.Run());
+    auto *root_loop = graph.GetRootLoop();
+    auto *loop_b = graph.FindBlock(B)->GetLoop();
+    size_t loops_num = graph.GetLoopsNum();
+
+    // Copy of the body of the outer loop, clones are indexed by the ids of the original blocks
+    BlocksVector clones(graph.GetBlockIdsNum());
+    for (auto id: {B, C, D, E, F, G, H, J}) {
+        auto *clone = GetAllocator()->New<BasicBlock>();
+        clone->SetGraph(&graph);
+        clones[id] = clone;
+    }
+    auto *clone = loop_b->Clone(clones);
+    ASSERT_EQ(graph.GetLoopsNum(), loops_num + 3);
+    ASSERT_EQ(clone->GetHeader(), clones[B]);
+    ASSERT_EQ(clone->GetOutLoop(), root_loop);
+    ASSERT_EQ(root_loop->GetInLoops().size(), 2);
+    ASSERT_EQ(clone->GetBackEdges().at(0), clones[H]);
+    ASSERT_EQ(clone->GetInLoops().size(), 2);
+    ASSERT_EQ(clone->GetLoopBlocks().size(), loop_b->GetLoopBlocks().size());
+    ASSERT_TRUE(clone->HasBlock(clones[J]));
+    ASSERT_TRUE(clone->Contains(clones[F]));
+    ASSERT_FALSE(clone->Contains(graph.FindBlock(F)));
+
+    auto *inner_clone = clones[D]->GetLoop();
+    ASSERT_EQ(inner_clone->GetHeader(), clones[C]);
+    ASSERT_EQ(inner_clone->GetOutLoop(), clone);
+    ASSERT_EQ(clones[D]->GetLoopDepth(), 2);
+    // The original loops are untouched
+    ASSERT_EQ(graph.FindBlock(D)->GetLoop()->GetOutLoop(), loop_b);
+    ASSERT_EQ(loop_b->GetInLoops().size(), 2);
+}
+
+// Preheader, single latch and dedicated exits of all the loops nested into the given one
+void TestLoopsSimplified(Loop *root_loop) {
+    std::vector<Loop *> loops{root_loop->GetInLoops().begin(), root_loop->GetInLoops().end()};
+    while (!loops.empty()) {
+        auto *loop = loops.back();
+        loops.pop_back();
+        loops.insert(loops.end(), loop->GetInLoops().begin(), loop->GetInLoops().end());
+        SCOPED_TRACE(loop->GetHeader()->GetId());
+
+        auto *preheader = loop->GetPreHeader();
+        ASSERT_NE(preheader, nullptr);
+        ASSERT_EQ(preheader->GetSuccs().size(), 1);
+        ASSERT_EQ(preheader->GetSuccs().front(), loop->GetHeader());
+        ASSERT_FALSE(loop->Contains(preheader));
+        ASSERT_EQ(loop->GetBackEdges().size(), 1);
+        for (auto *pred: loop->GetHeader()->GetPreds()) {
+            ASSERT_TRUE(pred == preheader || pred == loop->GetBackEdges().front());
+        }
+        for (auto *bb: loop->GetLoopBlocks()) {
+            for (auto *succ: bb->GetSuccs()) {
+                if (loop->Contains(succ)) {
+                    continue;
+                }
+                for (auto *exit_pred: succ->GetPreds()) {
+                    ASSERT_TRUE(loop->Contains(exit_pred));
+                }
+            }
+        }
+    }
+}
+
+TEST_F(GraphTest, Loop_Simplify) {
+    /*
+     *      A
+     *      ↓
+     *  ┌-→ B ←-┐
+     *  |  ↙ ↘  |
+     *  └ C   D ┘
+     *    ↓   ↓
+     *    E ← F
+     */
+    BasicBlock A, B, C, D, E, F;
+    BasicBlock::AddEdge(&A, &B);
+    BasicBlock::AddEdge(&B, &C);
+    BasicBlock::AddEdge(&B, &D);
+    BasicBlock::AddEdge(&C, &B);
+    BasicBlock::AddEdge(&C, &E);
+    BasicBlock::AddEdge(&D, &B);
+    BasicBlock::AddEdge(&D, &F);
+    BasicBlock::AddEdge(&F, &E);
+    Graph graph{GetAllocator(), &A, &E, 0};
+    graph.SetGraphForBasicBlocks({&A, &B, &C, &D, &E, &F});
+
+    auto &analyses = graph.GetAnalyses();
+    passes::LoopSimplify loop_simplify{&graph};
+    ASSERT_TRUE(analyses.RunPass(&loop_simplify));
+    // loops and the dominator tree are updated in place
+    ASSERT_TRUE(graph.IsLoopAnalysisValid());
+    ASSERT_TRUE(graph.IsDomTreeValid());
+    ASSERT_EQ(analyses.GetComputationsNum(Analysis::LOOP_INFO), 1);
+    CompareWithRebuiltDomTree(&graph);
+    TestLoopsSimplified(graph.GetRootLoop());
+
+    auto *loop = B.GetLoop();
+    // A already is the preheader
+    ASSERT_EQ(loop->GetPreHeader(), &A);
+    // Latches C and D are merged, the branches keep their order
+    auto *latch = loop->GetBackEdges().front();
+    ASSERT_EQ(latch->GetLoop(), loop);
+    ASSERT_EQ(latch->GetPreds().size(), 2);
+    ASSERT_EQ(C.GetSuccs().front(), latch);
+    ASSERT_EQ(D.GetSuccs().front(), latch);
+    ASSERT_EQ(latch->GetImmDom(), &B);
+    // F is the dedicated exit already, the edge from C to E is split
+    ASSERT_EQ(D.GetSuccs().back(), &F);
+    auto *exit = C.GetSuccs().back();
+    ASSERT_NE(exit, &E);
+    ASSERT_EQ(exit->GetSuccs().front(), &E);
+    ASSERT_EQ(exit->GetLoop(), graph.GetRootLoop());
+    ASSERT_EQ(exit->GetImmDom(), &C);
+}
+
+TEST_F(GraphTest, Loop_Simplify_Nested) {
+    using namespace G2_BB;
+    Graph graph = GetSecondGraph();
+    for (auto *block: passes::Traversal{&graph}.getRPO(true)) {
+        block->SetGraph(&graph);
+    }
+    passes::PassManager pass_manager{&graph};
+    ASSERT_TRUE(pass_manager.AddPipeline("loop-simplify"));
+    ASSERT_TRUE(pass_manager.Run());
+    ASSERT_TRUE(graph.IsLoopAnalysisValid());
+    CompareWithRebuiltDomTree(&graph);
+    TestLoopsSimplified(graph.GetRootLoop());
+
+    auto *loop_b = graph.FindBlock(B)->GetLoop();
+    ASSERT_EQ(loop_b->GetPreHeader(), graph.FindBlock(A));
+    // B and J enter the loop of C, D leaves the loop of C and enters the loop of E
+    auto *preheader_c = graph.FindBlock(C)->GetLoop()->GetPreHeader();
+    ASSERT_EQ(preheader_c->GetLoop(), loop_b);
+    ASSERT_EQ(preheader_c->GetPreds().size(), 2);
+    auto *preheader_e = graph.FindBlock(E)->GetLoop()->GetPreHeader();
+    ASSERT_EQ(preheader_e->GetLoop(), loop_b);
+    ASSERT_EQ(preheader_e->GetLoopDepth(), 1);
+}
+
 }  // namespace compiler::test
 
 int main(int argc, char **argv) {